@@ -11,6 +11,7 @@ Sections:
 - \link Controller.ino Controller \endlink
 - \link Commands Manual Commands \endlink
 - \link I2C_Master I2C_Master \endlink
+- \link BinaryProtocol Binary Plant Protocol \endlink
 
 Arduinos for Plant (top) and controller (below).
 
@@ -69,6 +70,7 @@ The washing machine running on an Arduino has following manual commands using th
 <tr><td> W? </td><td> warning </td></tr>
 <tr><td> V=x </td><td> verbose on/off </td></tr>
 <tr><td> R </td><td> (re)init </td></tr>
+<tr><td> B? </td><td> binary protocol version, asked by the controller at start and after R, see \link BinaryProtocol Binary Plant Protocol \endlink </td></tr>
 </table>
 with x either 1 or 0.
 
@@ -85,6 +87,8 @@ with x either 1 or 0.
 #include "Wire.h"
 // include I²C connection
 #include "I2C_Master.h"
+// include binary plant protocol
+#include "BinaryProtocol.h"
 
                                                 // time management
 //! for 10 msec detection
@@ -103,6 +107,10 @@ const long      I2C_FREQUENCY = 100000L;
 const int       SDA_PIN = 21;
 //! SCL pin
 const int       SCL_PIN = 22;
+//! binary protocol version of the plant, 0 for ASCII, see \link BinaryProtocol Binary Plant Protocol \endlink
+uint8_t         nPlantProtocol = 0;
+//! protocol query to be sent
+bool            bQueryProtocol = true;
 
                                                 // static const PLC IO output numbers
 const int       nWaterIntake = 5;               ///< water intake valve
@@ -288,12 +296,55 @@ bool InterpreteResponse(char szResponse[])
     case 'W':                                   // got a fresh warning bits value
       nWarnings = atoi(szResponse+2);           // convert response part after '=' to integer
       return true;                              // done
+    case 'B':                                   // got the binary protocol version
+      nPlantProtocol = Binary_ParseVersion(szResponse);
+      return true;                              // done
     // more cases may follow
     }
   }
   return false;                                 // response not handled
 }
 
+//! Interpret a binary I²C response from the plant
+/*!
+Interpret a binary response from the plant, see \link BinaryProtocol Binary Plant Protocol \endlink.
+
+Same as InterpreteResponse(), but the values come as scaled integers, no atof() required.
+
+\param pResponse response frame
+\param nLength frame length
+\returns true if response has been used
+*/
+bool InterpreteBinary(const uint8_t * pResponse, int nLength)
+{
+  bool  bUsed = false;
+  char  cId;
+  long  nValue;
+  int   nPos = 1;                               // behind the frame start
+  while ( ( nPos = Binary_Next(pResponse, nLength, nPos, &cId, &nValue) ) > 0 )
+  {
+    switch ( cId )
+    {
+    case 'T':                                   // time in 0.01 min
+      dTime = nValue / 100.0;
+      break;
+    case 'C':                                   // temperature in 0.01 °C
+      dTemperature = nValue / 100.0;
+      break;
+    case 'A':                                   // water level in g
+      dWaterLevel = nValue / 1000.0;
+      break;
+    case 'W':                                   // warning bits
+      nWarnings = nValue;
+      break;
+    default:
+      continue;                                 // not used
+    }
+    bUsed = true;
+  }
+  return bUsed;
+}
+
 //! Show some data values
 /*!
 Show some data values
@@ -328,10 +379,19 @@ void Task_100ms()
   static char  szCommand[I2C_DATA_MAX+1];       // buffer for commands
   static char  szResponse[I2C_DATA_MAX+1];      // buffer for responses
   static bool  bOperatesCommand = false;        // flag tells if request is under way
+  static bool  bSentBinary = false;             // flag tells if request went as binary frame
+  static uint8_t Frame[I2C_DATA_MAX];           // binary request
 
   if ( ! bOperatesCommand )                     // if not busy at working on a current command
   {
-    if ( CheckIfTypedAvailable(szCommand, I2C_DATA_MAX+1) )
+    if ( bQueryProtocol )
+    {                                           // ask for the binary protocol, ASCII until answered
+      strcpy(szCommand, BINARY_QUERY);
+      nPlantProtocol = 0;
+      bQueryProtocol = false;
+      bOperatesCommand = true;
+    }
+    else if ( CheckIfTypedAvailable(szCommand, I2C_DATA_MAX+1) )
     {
       bOperatesCommand = true;                  // we have a new manual command to work on
     }
@@ -347,6 +407,7 @@ void Task_100ms()
     if ( szCommand[0] == 'R' )                  // check special case first
     {
       ResetIO();                                // the reset command
+      bQueryProtocol = true;                    // plant possibly forgets its protocol
     }
     else if ( WorkOnCommandsForDigitalIO(szCommand) ) // check if command for digital IO
     {
@@ -358,8 +419,13 @@ void Task_100ms()
   if ( bOperatesCommand )                       // working on a current command
   {
     *szResponse = 0;                            // clean response
+    int           nLength = ( nPlantProtocol > 0 ) ? Binary_FromText(szCommand, Frame, sizeof(Frame), nPlantProtocol) : -1;
+    bSentBinary = ( nLength >= 0 );
     int           nRes;
-    nRes = I2C_SendRequest(I2C_PLANT_ADDR, szCommand); // request something from I²C slave
+    if ( bSentBinary )
+      nRes = I2C_SendRequest(I2C_PLANT_ADDR, Frame, nLength); // binary request
+    else
+      nRes = I2C_SendRequest(I2C_PLANT_ADDR, szCommand); // request something from I²C slave
     if ( nRes == -2 )
       Serial.println("request too long");
     if ( *szCommand == 'R' )                    // handle special "reset" request
@@ -367,10 +433,17 @@ void Task_100ms()
   }
 
   int           nSlaveNo;
-  int           nResult = I2C_GetResponse(&nSlaveNo, szResponse);
+  int           nResult = I2C_GetResponse(&nSlaveNo, (uint8_t *)szResponse);
   if ( nResult >= 0 )
   {
-    if ( ! InterpreteResponse(szResponse) )     // use response we got
+    szResponse[nResult] = 0;                    // trailing 0 for a text response
+    const uint8_t * pFrame = (const uint8_t *)szResponse;
+    bool  bBinary = ( Binary_Version(pFrame, nResult) > 0 );
+    if ( bSentBinary && ! bBinary )
+      nPlantProtocol = 0;                       // binary request answered in ASCII, old plant
+    if ( bBinary )
+      InterpreteBinary(pFrame, nResult);
+    else if ( ! InterpreteResponse(szResponse) ) // use response we got
     {
 #if 1                                           // possibly disable
       Serial.print(" -> ");                     // show not handled command and response
@@ -68,6 +68,17 @@ Will not necesarily get a response.
 */
 extern bool I2C_SendRequest(int nSlaveNo, const char * const pszRequest);
 
+//! Send binary request to slave
+/*!
+Send binary request to slave, e.g. a frame of the \link BinaryProtocol Binary Plant Protocol \endlink.
+The response is fetched with the binary I2C_GetResponse().
+\param nSlaveNo target slave number for the request
+\param pRequest request bytes
+\param nLength number of bytes
+\return true on success
+*/
+extern bool I2C_SendRequest(int nSlaveNo, const uint8_t * pRequest, int nLength);
+
 //! Get binary response for last request
 /*!
 Gets a received binary response.
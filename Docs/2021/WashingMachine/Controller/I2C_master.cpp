@@ -122,6 +122,16 @@ bool I2C_SendRequest(int nSlaveNo, const char * const pszRequest)
   return true;
 }
 
+// Send binary request to slave
+bool I2C_SendRequest(int nSlaveNo, const uint8_t * pRequest, int nLength)
+{
+  int   res = I2C_SendMessage(nSlaveNo, pRequest, nLength);
+  if ( res < 0 )
+    return false;                               // send request failed
+  nRequestTime = micros();
+  return true;
+}
+
 // Get binary response for last request
 int I2C_GetResponse(int * pnSlaveNo, uint8_t * puiResponse)
 {
@@ -0,0 +1,237 @@
+/* Arduino HAL shim, simulated clock, pins and Serial
+*/
+
+// include Arduino HAL shim
+#include "Arduino.h"
+// include native simulation control
+#include "Native.h"
+
+//! pin state
+struct NativePin
+{
+  uint8_t       nMode;                          ///< INPUT or OUTPUT
+  uint8_t       nOutput;                        ///< level written, for an input the pull up
+  uint8_t       nInput;                         ///< level driven from outside
+  bool          bDriven;                        ///< driven from outside
+};
+
+                                                // native data
+//! simulated time in usec
+static unsigned long long usecClock = 0;
+//! simulated pins
+static NativePin      Pins[NATIVE_PINS];
+//! typed, not yet read input of Serial
+static std::string    SerialInput;
+//! read position in SerialInput
+static size_t         nSerialRead = 0;
+//! drop the output of Serial
+static bool           bSerialQuiet = false;
+
+HardwareSerial  Serial;
+
+// Advance the clock
+void Native_Advance(unsigned long usec)
+{
+  usecClock += usec;
+}
+
+// Simulated time
+unsigned long long Native_Time()
+{
+  return usecClock;
+}
+
+// Time since start in msec
+unsigned long millis()
+{
+  return (unsigned long)( usecClock / 1000 );
+}
+
+// Time since start in usec
+unsigned long micros()
+{
+  return (unsigned long)usecClock;
+}
+
+// Wait
+void delay(unsigned long msec)
+{
+  usecClock += msec * 1000ULL;
+}
+
+// Wait
+void delayMicroseconds(unsigned int usec)
+{
+  usecClock += usec;
+}
+
+// Set the pin mode
+void pinMode(uint8_t nPin, uint8_t nMode)
+{
+  if ( nPin >= NATIVE_PINS )
+    return;
+  Pins[nPin].nMode = ( nMode == OUTPUT ) ? OUTPUT : INPUT;
+  if ( nMode != OUTPUT )
+    Pins[nPin].nOutput = ( nMode == INPUT_PULLUP ) ? HIGH : LOW; // as the port register of the AVR
+}
+
+// Read a pin
+int digitalRead(uint8_t nPin)
+{
+  if ( nPin >= NATIVE_PINS )
+    return LOW;
+  const NativePin & pin = Pins[nPin];
+  if ( pin.nMode == OUTPUT )
+    return pin.nOutput;
+  if ( pin.bDriven )
+    return pin.nInput;
+  return pin.nOutput;                           // pull up on or off, e.g. by digitalWrite()
+}
+
+// Write a pin
+void digitalWrite(uint8_t nPin, uint8_t nLevel)
+{
+  if ( nPin < NATIVE_PINS )
+    Pins[nPin].nOutput = ( nLevel != LOW ) ? HIGH : LOW;
+}
+
+// Drive an input
+void Native_SetPin(uint8_t nPin, uint8_t nLevel)
+{
+  if ( nPin >= NATIVE_PINS )
+    return;
+  Pins[nPin].nInput = ( nLevel != LOW ) ? HIGH : LOW;
+  Pins[nPin].bDriven = true;
+}
+
+// Release an input
+void Native_ReleasePin(uint8_t nPin)
+{
+  if ( nPin < NATIVE_PINS )
+    Pins[nPin].bDriven = false;
+}
+
+// Level of an output
+int Native_Pin(uint8_t nPin)
+{
+  return ( nPin < NATIVE_PINS ) ? Pins[nPin].nOutput : LOW;
+}
+
+// Integer to text
+char * ltoa(long nValue, char * psz, int nBase)
+{
+  char          szDigits[8 * sizeof(long) + 1];
+  char *        p = szDigits + sizeof(szDigits);
+  unsigned long nRest = ( ( nValue < 0 ) && ( nBase == 10 ) ) ? -(unsigned long)nValue : (unsigned long)nValue;
+  *--p = 0;
+  do
+  {
+    *--p = "0123456789abcdefghijklmnopqrstuvwxyz"[nRest % nBase];
+    nRest /= nBase;
+  } while ( nRest != 0 );
+  char *        q = psz;
+  if ( ( nValue < 0 ) && ( nBase == 10 ) )
+    *q++ = '-';
+  strcpy(q, p);
+  return psz;
+}
+
+// Integer to text
+char * itoa(int nValue, char * psz, int nBase)
+{
+  if ( nBase != 10 )
+    return ltoa((long)(unsigned int)nValue, psz, nBase); // two's complement as on the Uno
+  return ltoa(nValue, psz, nBase);
+}
+
+// Write bytes
+size_t Print::write(const uint8_t * pData, size_t nLength)
+{
+  size_t        n = 0;
+  while ( nLength-- > 0 )
+    n += write(*pData++);
+  return n;
+}
+
+// Print a number
+size_t Print::print(long n, int nBase)
+{
+  char          sz[8 * sizeof(long) + 2];
+  return write(ltoa(n, sz, nBase));
+}
+
+// Print a number
+size_t Print::print(unsigned long n, int nBase)
+{
+  char          sz[8 * sizeof(long) + 2];
+  char *        p = sz + sizeof(sz);
+  *--p = 0;
+  do
+  {
+    *--p = "0123456789ABCDEF"[n % nBase];
+    n /= nBase;
+  } while ( n != 0 );
+  return write(p);
+}
+
+// Print a floating point number
+size_t Print::print(double d, int nDigits)
+{
+  char          sz[48];
+  snprintf(sz, sizeof(sz), "%.*f", nDigits, d);
+  return write(sz);
+}
+
+// Bytes typed
+int HardwareSerial::available()
+{
+  return (int)( SerialInput.size() - nSerialRead );
+}
+
+// Read a typed byte
+int HardwareSerial::read()
+{
+  if ( nSerialRead >= SerialInput.size() )
+    return -1;
+  int   c = (uint8_t)SerialInput[nSerialRead++];
+  if ( nSerialRead == SerialInput.size() )
+  {                                             // all read, start over
+    SerialInput.clear();
+    nSerialRead = 0;
+  }
+  return c;
+}
+
+// Next typed byte without reading it
+int HardwareSerial::peek()
+{
+  return ( nSerialRead < SerialInput.size() ) ? (uint8_t)SerialInput[nSerialRead] : -1;
+}
+
+// Write a byte
+size_t HardwareSerial::write(uint8_t c)
+{
+  if ( ! bSerialQuiet )
+    putchar(c);
+  return 1;
+}
+
+// Write bytes
+size_t HardwareSerial::write(const uint8_t * pData, size_t nLength)
+{
+  if ( ! bSerialQuiet )
+    fwrite(pData, 1, nLength, stdout);
+  return nLength;
+}
+
+// Type on Serial
+void Native_SerialInput(const char * pszText)
+{
+  SerialInput += pszText;
+}
+
+// Silence Serial
+void Native_SerialQuiet(bool bQuiet)
+{
+  bSerialQuiet = bQuiet;
+}
@@ -0,0 +1,176 @@
+/*! \page Native Native Build
+Arduino HAL shim for the host build [env:native].
+
+The controller sources, Controller.ino and all modules in src, compile unchanged on Linux
+against this small subset of the Arduino core, see platformio.ini:
+<pre>
+pio run -e native
+.pio/build/native/program -t 3600 -i program1.txt
+</pre>
+The Unity tests of single modules in test, fixed point values, binary protocol, telemetry and scheduler,
+link the same sources without the main() of main.cpp:
+<pre>
+pio test -e native
+</pre>
+
+Time is simulated.
+The clock stands still while loop() runs and advances by a fixed step after every call of loop(),
+by delay() and delayMicroseconds() and by the bus time of every I²C transfer.
+So runs are deterministic and much faster than real time, one hour of a wash program takes a few seconds.
+Execution times measured with micros() are therefore meaningless, the profiler is off in the native build.
+
+Provided are millis(), micros(), delay(), delayMicroseconds(), pinMode(), digitalRead(), digitalWrite(),
+Serial on stdout, SoftwareSerial without a peer, Wire as master with simulated slaves and Metro.
+TWI and timer registers do not exist, all AVR specific code is compiled for the Wire fallback,
+see \link TwiMaster TWI Master Driver \endlink.
+The Timer0 compare interrupt sampling the door is replaced by a call of Door_Sample() every simulated millisecond.
+
+Simulated slaves, inputs and the clock are controlled by the functions in Native.h,
+the run itself by the command line of the program:
+<table border="0" width="80%">
+<tr><td> -t s    </td><td> simulated run time in sec, default 60 </td></tr>
+<tr><td> -s usec </td><td> time step per call of loop() in usec, default NATIVE_STEP_US </td></tr>
+<tr><td> -i file </td><td> script of typed commands for Serial, one per line, "@msec command" delays it to that time </td></tr>
+<tr><td> -q      </td><td> no Serial output </td></tr>
+<tr><td> -l      </td><td> legacy plant, as the binary of the real plant </td></tr>
+<tr><td> -n      </td><td> no plant </td></tr>
+<tr><td> -c file </td><td> replay a recorded trace through the plant model and print the deviations, no run </td></tr>
+<tr><td> -r log  </td><td> replay recorded I²C transactions instead of the plant, see \link I2C_Master I2C Master \endlink and Replay.h </td></tr>
+</table>
+The plant at address 10 is simulated by default, see \link Plant Plant Simulator \endlink.
+At the end the simulated and the host run time and a summary of the plant or the replay are printed to stderr.
+
+A replay benchmarks the controller with a workload captured in the field, e.g.
+<pre>
+tools/i2c_capture.py /dev/ttyACM0 field.log       # after typing c=1 on the controller
+.pio/build/native/program -q -t 3600 -r field.log
+</pre>
+With c=1 in the script of the replay the controller records again, the records match the captured ones
+as long as the controller asks the same.
+
+Pins behave like the AVR ports, digitalWrite() to an input switches its pull up.
+
+Differences to the Uno worth to know: int is 32 bit and long 64 bit,
+double is double precision and there is no PROGMEM, the pgm_read functions read plain memory.
+F() keeps the type of the Uno, so prints of flash strings are checked as there.
+*/
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+                                                // Arduino attributes
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define DEC             10
+#define HEX             16
+#define PROGMEM
+#define F(s)            ( (const __FlashStringHelper *)(s) )
+#define PSTR(s)         (s)
+#define pgm_read_byte(p)  ( *(const uint8_t *)(p) )
+#define pgm_read_word(p)  ( *(const uint16_t *)(p) )
+#define pgm_read_ptr(p)   ( *(void * const *)(p) )
+#define memcpy_P        memcpy
+#define strcmp_P        strcmp
+#define strlen_P        strlen
+#ifndef min
+#define min(a,b)        ( (a) < (b) ? (a) : (b) )
+#define max(a,b)        ( (a) > (b) ? (a) : (b) )
+#endif
+#define constrain(x,lo,hi)  ( (x) < (lo) ? (lo) : ( (x) > (hi) ? (hi) : (x) ) )
+
+class __FlashStringHelper;
+
+typedef bool            boolean;
+typedef uint8_t         byte;
+
+                                                // Arduino prototypes
+extern unsigned long millis();
+extern unsigned long micros();
+extern void delay(unsigned long msec);
+extern void delayMicroseconds(unsigned int usec);
+extern void pinMode(uint8_t nPin, uint8_t nMode);
+extern int digitalRead(uint8_t nPin);
+extern void digitalWrite(uint8_t nPin, uint8_t nLevel);
+inline void noInterrupts() { }
+inline void interrupts() { }
+extern char * itoa(int nValue, char * psz, int nBase);
+extern char * ltoa(long nValue, char * psz, int nBase);
+
+//! Arduino String, as far as used
+class String
+{
+public:
+  String(const char * psz = "") : str(psz) { }
+  bool concat(char c) { str += c; return true; }
+  bool concat(const char * psz) { str += psz; return true; }
+  const char * c_str() const { return str.c_str(); }
+  unsigned int length() const { return str.length(); }
+private:
+  std::string   str;
+};
+
+//! Arduino Print, numbers are printed as text, char as character
+class Print
+{
+public:
+  virtual ~Print() { }
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t * pData, size_t nLength);
+  size_t write(const char * psz) { return write((const uint8_t *)psz, strlen(psz)); }
+  size_t write(const char * pData, size_t nLength) { return write((const uint8_t *)pData, nLength); }
+
+  size_t print(const char * psz) { return write(psz); }
+  size_t print(const __FlashStringHelper * psz) { return write((const char *)psz); }
+  size_t print(const String & s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char n, int nBase = DEC) { return print((unsigned long)n, nBase); }
+  size_t print(int n, int nBase = DEC) { return print((long)n, nBase); }
+  size_t print(unsigned int n, int nBase = DEC) { return print((unsigned long)n, nBase); }
+  size_t print(long n, int nBase = DEC);
+  size_t print(unsigned long n, int nBase = DEC);
+  size_t print(double d, int nDigits = 2);
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T> size_t println(T value, int nFormat) { size_t n = print(value, nFormat); return n + println(); }
+};
+
+//! Arduino Stream, input part
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+//! Serial port on stdout, input from the script of the command line
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long nBaud) { (void)nBaud; }
+  void end() { }
+  int available() override;
+  int read() override;
+  int peek() override;
+  int availableForWrite() { return 63; }        // never blocks
+  void flush() { fflush(stdout); }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t * pData, size_t nLength) override;
+  using Print::write;
+  operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H
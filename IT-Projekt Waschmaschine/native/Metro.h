@@ -0,0 +1,30 @@
+/* Metro interval timer on the simulated clock, see \link Native Native Build \endlink
+*/
+
+#ifndef METRO_H
+#define METRO_H
+
+// include Arduino HAL shim
+#include "Arduino.h"
+
+//! Metro, interval timer in msec
+class Metro
+{
+public:
+  Metro(unsigned long msecInterval) : msecInterval(msecInterval), msecPrevious(millis()) { }
+  void interval(unsigned long msecInterval) { this->msecInterval = msecInterval; }
+  void reset() { msecPrevious = millis(); }
+  bool check()
+  {
+    if ( millis() - msecPrevious < msecInterval )
+      return false;
+    msecPrevious = millis();
+    return true;
+  }
+
+private:
+  unsigned long msecInterval;                   ///< interval
+  unsigned long msecPrevious;                   ///< last expiry
+};
+
+#endif // METRO_H
@@ -0,0 +1,94 @@
+/* Control of the simulated hardware of the native build, see \link Native Native Build \endlink
+*/
+
+#ifndef NATIVE_H
+#define NATIVE_H
+
+// include Arduino HAL shim
+#include "Arduino.h"
+
+                                                // native attributes
+//! number of simulated digital pins
+const int       NATIVE_PINS = 20;
+//! number of simulated I²C slaves
+const int       NATIVE_SLAVES_MAX = 4;
+//! default time step per call of loop() in usec, about the loop time on the Uno
+const unsigned long NATIVE_STEP_US = 100;
+
+//! simulated I²C slave, the callbacks of the Wire slave mode
+struct NativeSlave
+{
+  void          (*pfnReceive)(const uint8_t * pData, int nLength); ///< master has written
+  int           (*pfnRequest)(uint8_t * pData, int nMax);          ///< master reads, returns bytes sent
+  void          (*pfnStep)(unsigned long usecNow);                 ///< called after every time step, may be nullptr
+};
+
+                                                // native prototypes
+//! Advance the clock
+/*!
+Advance the simulated clock.
+\param usec time in usec
+*/
+extern void Native_Advance(unsigned long usec);
+
+//! Simulated time
+/*!
+Simulated time since start, not wrapping.
+\return time in usec
+*/
+extern unsigned long long Native_Time();
+
+//! Drive an input
+/*!
+Drive a pin from outside, e.g. a sensor.
+An input with pull up reads HIGH while not driven.
+\param nPin pin number
+\param nLevel HIGH or LOW
+*/
+extern void Native_SetPin(uint8_t nPin, uint8_t nLevel);
+
+//! Release an input
+/*!
+Stop driving a pin from outside.
+\param nPin pin number
+*/
+extern void Native_ReleasePin(uint8_t nPin);
+
+//! Level of an output
+/*!
+Level written by the controller, e.g. to a valve.
+\param nPin pin number
+\return HIGH or LOW
+*/
+extern int Native_Pin(uint8_t nPin);
+
+//! Type on Serial
+/*!
+Append text to the input of Serial, as typed on the serial monitor.
+\param pszText text, usually a command with trailing newline
+*/
+extern void Native_SerialInput(const char * pszText);
+
+//! Silence Serial
+/*!
+Drop or print the output of Serial.
+\param bQuiet true to drop it
+*/
+extern void Native_SerialQuiet(bool bQuiet);
+
+//! Attach a simulated I²C slave
+/*!
+Attach a simulated I²C slave, requests to an address without slave are not acknowledged.
+\param nAddress slave address
+\param pSlave callbacks, have to remain valid
+\return false if no slave can be attached any more
+*/
+extern bool Native_AttachSlave(uint8_t nAddress, const NativeSlave * pSlave);
+
+//! Step the simulated slaves
+/*!
+Call the step function of all simulated slaves, done by the main loop after every time step.
+*/
+extern void Native_StepSlaves();
+
+#endif // NATIVE_H
@@ -0,0 +1,606 @@
+/* Washing machine plant model as simulated I²C slave, see \link Plant Plant Simulator \endlink
+*/
+
+// include Arduino HAL shim
+#include "Arduino.h"
+// include native simulation control
+#include "Native.h"
+// include plant simulator
+#include "Plant.h"
+// include I²C length prefix
+#include "I2C_Master.h"
+// include binary protocol
+#include "BinaryProtocol.h"
+
+//! model state
+struct PlantState
+{
+  double        dWater;                         ///< A, water in the tub in kg
+  double        dAbsorbed;                      ///< w, water in the laundry in kg
+  double        dTemperature;                   ///< C in °C
+  double        dEnergy;                        ///< k, heating energy in kWh
+  double        dDetergent;                     ///< detergent left in the water
+  double        dSoftener;                      ///< softener left in the water
+  double        dRpm;                           ///< r, drum speed
+  double        dWaterUsed;                     ///< water taken in kg
+  int           nRpmSet;                        ///< drum speed setpoint
+  int           nLaundry;                       ///< L, laundry in kg
+  bool          bDoorClosed;                    ///< D
+  bool          bIntake;                        ///< I, valve open in this step
+  bool          bPump;                          ///< P, pump on in this step
+  bool          bHeating;                       ///< H, heating on in this step
+  uint8_t       nWarnings;                      ///< W, see PlantWarning
+};
+
+//! register of the plant
+struct PlantRegister
+{
+  char          cKey;                           ///< command character
+  uint8_t       nSize;                          ///< binary size in bytes
+  double        dScale;                         ///< binary units per unit of the value
+  uint8_t       nDigits;                        ///< decimals of the ASCII value
+  long          nDeadband;                      ///< min binary change flagged in the change status
+};
+
+                                                // plant data
+//! registers, the binary sizes as in the \link BinaryProtocol Binary Plant Protocol \endlink
+static const PlantRegister Registers[] =
+{
+  { 'T', 4, 100.0,  2, 1 },                     // time in min
+  { 't', 1, 1.0,    0, 1 },                     // time lapse
+  { 'C', 2, 100.0,  2, 10 },                    // temperature in °C
+  { 'D', 1, 1.0,    0, 1 },                     // door closed
+  { 'L', 2, 1.0,    0, 1 },                     // laundry in kg
+  { 'I', 1, 1.0,    0, 1 },                     // water intake valve
+  { 'A', 2, 1000.0, 3, 10 },                    // water level in kg
+  { 'H', 1, 1.0,    0, 1 },                     // heating
+  { 'w', 2, 1000.0, 3, 10 },                    // water in laundry in kg
+  { 'k', 2, 1000.0, 3, 1 },                     // heating energy in kWh
+  { 'P', 1, 1.0,    0, 1 },                     // water pump
+  { 'O', 2, 1.0,    0, 1 },                     // detergent
+  { 'o', 2, 1.0,    0, 1 },                     // detergent and softener
+  { 'r', 2, 1.0,    0, 1 },                     // drum speed
+  { 'W', 2, 1.0,    0, 1 },                     // warnings
+  { 'Z', 2, 1.0,    0, 0 },                     // change status, extended plant only
+  { 'B', 1, 1.0,    0, 0 },                     // binary protocol version, extended plant only
+};
+//! number of registers
+const int       REGISTER_COUNT = sizeof(Registers) / sizeof(Registers[0]);
+//! keys of the change status bits, bit 0 first, as szStatusKeys of the controller
+static const char szStatusKeys[] = "WTCArLow";
+//! bit set in every change status
+const uint16_t  STATUS_VALID = 0x8000;
+
+//! model
+static PlantState     State;
+//! behave like the binary of the real plant
+static bool           bLegacy = false;
+//! time lapse mode
+static bool           bTimeLapse = false;
+//! manual commands I=1, H=1 and P=1
+static bool           bManualIntake = false, bManualHeating = false, bManualPump = false;
+//! plant time in msec
+static unsigned long long msecPlant = 0;
+//! simulated time of the last model step in usec
+static unsigned long long usecModel = 0;
+//! binary value of the change status keys when read last
+static long           LastRead[sizeof(szStatusKeys) - 1];
+//! response to the last request
+static uint8_t        Response[I2C_FRAMED_MAX];
+//! response length
+static int            nResponseLength = 0;
+//! response bytes read
+static int            nResponseRead = 0;
+//! length prefix read
+static bool           bHeaderSent = false;
+//! warnings seen since start
+static uint8_t        nWarningsSeen = 0;
+//! requests served, all and binary
+static unsigned long  nRequests = 0, nBinaryRequests = 0;
+
+//! Reset the model
+/*!
+Reset the model to an empty machine at PLANT_T_START with the door open, as after power on.
+\param state model
+*/
+static void ResetState(PlantState & state)
+{
+  memset(&state, 0, sizeof(state));
+  state.dTemperature = PLANT_T_START;
+}
+
+//! Integrate one step
+/*!
+Integrate the model over one step, see \link Plant Plant Simulator \endlink.
+The actuators are taken from the state.
+\param state model
+\param secStep step in sec
+*/
+static void Integrate(PlantState & state, double secStep)
+{
+  uint8_t       nWarnings = 0;
+  double        dCapacity = PLANT_C_WATER * ( state.dWater + state.dAbsorbed ) + PLANT_C_LAUNDRY * state.nLaundry + PLANT_C_DRUM;
+  if ( state.bIntake )
+  {                                             // fresh water, mixed at once
+    double  dIn = PLANT_INFLOW * secStep;
+    state.dTemperature += ( PLANT_T_INLET - state.dTemperature ) * PLANT_C_WATER * dIn / ( dCapacity + PLANT_C_WATER * dIn );
+    state.dWater += dIn;
+    state.dWaterUsed += dIn;
+    if ( state.dWater > PLANT_LEVEL_MAX )
+    {
+      state.dWater = PLANT_LEVEL_MAX;
+      nWarnings |= PLANT_WARN_OVERFLOW;
+    }
+  }
+  if ( state.bPump && ( state.dWater > 0 ) )
+  {                                             // detergent leaves with the water
+    double  dOut = min(state.dWater, PLANT_OUTFLOW * secStep);
+    double  dShare = dOut / ( state.dWater + state.dAbsorbed );
+    state.dDetergent -= state.dDetergent * dShare;
+    state.dSoftener -= state.dSoftener * dShare;
+    state.dWater -= dOut;
+  }
+  double        dAbsorbMax = PLANT_ABSORB * state.nLaundry;
+  if ( ( state.dAbsorbed < dAbsorbMax ) && ( state.dWater > 0 ) )
+  {                                             // laundry soaks up water
+    double  dSoak = min(min(state.dWater, dAbsorbMax - state.dAbsorbed), PLANT_ABSORB_RATE * secStep);
+    state.dAbsorbed += dSoak;
+    state.dWater -= dSoak;
+  }
+  int           nRpmTarget = state.bDoorClosed ? state.nRpmSet : 0;
+  state.dRpm += ( nRpmTarget - state.dRpm ) * ( 1.0 - exp(-secStep / PLANT_DRUM_TAU_S) );
+  if ( ( fabs(state.dRpm) >= PLANT_SPIN_RPM ) && ( state.dAbsorbed > 0 ) )
+  {                                             // spinning gives the water back
+    double  dSpun = min(state.dAbsorbed, PLANT_SPIN_RATE * secStep);
+    state.dAbsorbed -= dSpun;
+    if ( state.bPump )
+    {                                           // pumped off at once
+      double  dShare = dSpun / ( state.dWater + state.dAbsorbed + dSpun );
+      state.dDetergent -= state.dDetergent * dShare;
+      state.dSoftener -= state.dSoftener * dShare;
+    }
+    else
+      state.dWater += dSpun;
+  }
+
+  dCapacity = PLANT_C_WATER * ( state.dWater + state.dAbsorbed ) + PLANT_C_LAUNDRY * state.nLaundry + PLANT_C_DRUM;
+  double        dPower = -PLANT_LOSS_KW_PER_K * ( state.dTemperature - PLANT_T_AMBIENT );
+  if ( state.bHeating )
+  {
+    if ( state.dWater >= PLANT_LEVEL_HEATER )
+    {
+      double  dHeater = max(0.0, PLANT_HEATER_KW_PER_K * ( PLANT_HEATER_T_MAX - state.dTemperature ));
+      state.dEnergy += dHeater * secStep / 3600.0;
+      dPower += dHeater;
+    }
+    else
+      nWarnings |= PLANT_WARN_DRY;              // heater switched off by its thermal fuse
+  }
+  state.dTemperature += dPower * secStep / dCapacity;
+
+  if ( ! state.bDoorClosed && ( ( state.dWater > 0.01 ) || ( fabs(state.dRpm) >= 1.0 ) ) )
+    nWarnings |= PLANT_WARN_DOOR;
+  if ( state.dTemperature > PLANT_T_HOT )
+    nWarnings |= PLANT_WARN_HOT;
+  state.nWarnings = nWarnings;
+}
+
+//! Find a register
+/*!
+\param cKey command character
+\return register, nullptr if unknown or an extension of a legacy plant
+*/
+static const PlantRegister * FindRegister(char cKey)
+{
+  if ( bLegacy && ( ( cKey == 'Z' ) || ( cKey == 'B' ) ) )
+    return nullptr;                             // not known to the real plant
+  for ( int i = 0; i < REGISTER_COUNT; ++i )
+    if ( Registers[i].cKey == cKey )
+      return &Registers[i];
+  return nullptr;
+}
+
+//! Value of a register
+/*!
+\param reg register
+\return value in the unit of the ASCII response
+*/
+static double Value(const PlantRegister & reg);
+
+//! Scaled value of a register
+/*!
+\param reg register
+\return value in binary units
+*/
+static long Scaled(const PlantRegister & reg)
+{
+  return lround(Value(reg) * reg.dScale);
+}
+
+//! Change status
+/*!
+One bit per key of szStatusKeys changed since read, at least by its dead band.
+\return change status word with STATUS_VALID
+*/
+static uint16_t ChangeStatus()
+{
+  uint16_t      nStatus = STATUS_VALID;
+  for ( int i = 0; szStatusKeys[i] != 0; ++i )
+  {
+    long  nDelta = Scaled(*FindRegister(szStatusKeys[i])) - LastRead[i];
+    if ( labs(nDelta) >= FindRegister(szStatusKeys[i])->nDeadband )
+      nStatus |= 1U << i;
+  }
+  return nStatus;
+}
+
+// Value of a register
+static double Value(const PlantRegister & reg)
+{
+  switch ( reg.cKey )
+  {
+  case 'T': return msecPlant / 60000.0;
+  case 't': return bTimeLapse;
+  case 'C': return State.dTemperature;
+  case 'D': return State.bDoorClosed;
+  case 'L': return State.nLaundry;
+  case 'I': return State.bIntake;
+  case 'A': return State.dWater;
+  case 'H': return State.bHeating;
+  case 'w': return State.dAbsorbed;
+  case 'k': return State.dEnergy;
+  case 'P': return State.bPump;
+  case 'O': return State.dDetergent;
+  case 'o': return State.dDetergent + State.dSoftener;
+  case 'r': return State.dRpm;
+  case 'W': return State.nWarnings;
+  case 'Z': return ChangeStatus();
+  case 'B': return BINARY_VERSION;
+  default:  return 0;
+  }
+}
+
+//! Take a read
+/*!
+Mark a value as read for the change status.
+\param reg register read
+*/
+static void TakeRead(const PlantRegister & reg)
+{
+  const char *  p = strchr(szStatusKeys, reg.cKey);
+  if ( p != nullptr )
+    LastRead[p - szStatusKeys] = Scaled(reg);
+}
+
+//! Write a register
+/*!
+Write a register as the commands D=x L=n I=x H=x P=x O=n o=n r=n t=x V=x do.
+\param cKey command character
+\param nValue value written
+\param pnTaken storage for the value taken, the acknowledge
+\return false if the register cannot be written
+*/
+static bool Write(char cKey, long nValue, long * pnTaken)
+{
+  switch ( cKey )
+  {
+  case 'D': State.bDoorClosed = ( nValue != 0 ); nValue = State.bDoorClosed; break;
+  case 'L': nValue = constrain(nValue, 0L, (long)PLANT_LAUNDRY_MAX); State.nLaundry = nValue; break;
+  case 'I': bManualIntake = ( nValue != 0 ); nValue = bManualIntake; break;
+  case 'H': bManualHeating = ( nValue != 0 ); nValue = bManualHeating; break;
+  case 'P': bManualPump = ( nValue != 0 ); nValue = bManualPump; break;
+  case 'O': nValue = max(nValue, 0L); State.dDetergent += nValue; break;
+  case 'o': nValue = max(nValue, 0L); State.dSoftener += nValue; break;
+  case 'r': nValue = constrain(nValue, -(long)PLANT_RPM_MAX, (long)PLANT_RPM_MAX); State.nRpmSet = nValue; break;
+  case 't': bTimeLapse = ( nValue != 0 ); nValue = bTimeLapse; break;
+  case 'V': nValue = ( nValue != 0 ); break;   // nothing to be verbose about
+  default:  return false;
+  }
+  *pnTaken = nValue;
+  return true;
+}
+
+//! Reset the plant
+/*!
+Reset the plant, R or setup.
+*/
+static void Reset()
+{
+  ResetState(State);
+  bTimeLapse = false;
+  bManualIntake = bManualHeating = bManualPump = false;
+  msecPlant = 0;
+  for ( int i = 0; szStatusKeys[i] != 0; ++i )
+    LastRead[i] = Scaled(*FindRegister(szStatusKeys[i]));
+}
+
+//! Append a value to the ASCII response
+/*!
+Append "k=value", separated by ';' from a previous one.
+\param cKey command character
+\param dValue value
+\param nDigits decimals
+*/
+static void AppendText(char cKey, double dValue, int nDigits)
+{
+  char          szValue[24];
+  int           n = snprintf(szValue, sizeof(szValue), "%s%c=%.*f", ( nResponseLength > 0 ) ? ";" : "", cKey, nDigits, dValue);
+  if ( nResponseLength + n > (int)sizeof(Response) )
+    return;                                     // full, dropped
+  memcpy(Response + nResponseLength, szValue, n);
+  nResponseLength += n;
+}
+
+//! Answer an ASCII request
+/*!
+Answer an ASCII request of reads "k?", writes "k=n" and R.
+A legacy plant answers the first command only.
+\param pszRequest request
+*/
+static void AnswerText(const char * pszRequest)
+{
+  const char *  p = pszRequest;
+  while ( *p != 0 )
+  {
+    if ( ( *p == ';' ) || ( *p == ',' ) || ( *p == ' ' ) || ( *p == '\r' ) || ( *p == '\n' ) )
+    {
+      ++p;                                      // skip separators
+      continue;
+    }
+    char    cKey = *p++;
+    if ( *p == '?' )
+    {
+      ++p;
+      const PlantRegister * pReg = FindRegister(cKey);
+      if ( pReg != nullptr )
+      {
+        AppendText(cKey, Value(*pReg), pReg->nDigits);
+        TakeRead(*pReg);
+      }
+    }
+    else if ( *p == '=' )
+    {
+      char *  pEnd;
+      long    nTaken;
+      long    nValue = strtol(p+1, &pEnd, 10);
+      p = pEnd;
+      while ( ( *p != 0 ) && ( *p != ';' ) && ( *p != ',' ) && ( *p != ' ' ) && ( *p != '\r' ) && ( *p != '\n' ) )
+        ++p;                                    // decimals
+      if ( Write(cKey, nValue, &nTaken) )
+        AppendText(cKey, nTaken, 0);            // acknowledge
+    }
+    else if ( cKey == 'R' )
+      Reset();
+    if ( bLegacy )
+      break;                                    // one command per request
+  }
+}
+
+//! Answer a binary request
+/*!
+Answer a binary frame, see \link BinaryProtocol Binary Plant Protocol \endlink,
+with an entry for every read and the acknowledge of every write.
+\param pFrame request frame
+\param nLength frame length
+*/
+static void AnswerBinary(const uint8_t * pFrame, int nLength)
+{
+  nResponseLength = Binary_Begin(Response);
+  int           nPos = 1;                       // behind the frame start
+  char          cId;
+  long          nValue;
+  while ( nPos + 1 < nLength )
+  {
+    bool  bRead = ( pFrame[nPos+1] == 0 );      // the controller sends known sizes only
+    nPos = Binary_Next(pFrame, nLength, nPos, &cId, &nValue);
+    if ( nPos <= 0 )
+      break;
+    const PlantRegister * pReg = FindRegister(cId);
+    if ( pReg == nullptr )
+      continue;
+    if ( ! bRead )
+    {
+      long  nTaken;
+      if ( ! Write(cId, nValue, &nTaken) )
+        continue;
+      nValue = lround(nTaken * pReg->dScale);
+    }
+    else
+    {
+      nValue = Scaled(*pReg);
+      TakeRead(*pReg);
+    }
+    int   n = Binary_AddValue(Response, nResponseLength, sizeof(Response), cId, nValue, pReg->nSize);
+    if ( n > 0 )
+      nResponseLength = n;
+  }
+}
+
+//! Drive the attention line
+/*!
+Pull the attention line low while a change of the warnings has not been read, extended plant only.
+*/
+static void UpdateAttention()
+{
+  if ( ! bLegacy && ( ChangeStatus() & 1 ) )
+    Native_SetPin(PLANT_PIN_ATTENTION, LOW);    // warnings changed, not yet read
+  else
+    Native_ReleasePin(PLANT_PIN_ATTENTION);
+}
+
+//! Master has written
+/*!
+Take a request and prepare its response.
+\param pData request
+\param nLength request length
+*/
+static void Receive(const uint8_t * pData, int nLength)
+{
+  ++nRequests;
+  nResponseLength = 0;
+  nResponseRead = 0;
+  bHeaderSent = false;
+  if ( ! bLegacy && ( Binary_Version(pData, nLength) > 0 ) )
+  {
+    ++nBinaryRequests;
+    AnswerBinary(pData, nLength);
+  }
+  else
+  {
+    char        szRequest[I2C_DATA_MAX + 1];
+    nLength = min(nLength, I2C_DATA_MAX);
+    memcpy(szRequest, pData, nLength);
+    szRequest[nLength] = 0;
+    AnswerText(szRequest);
+  }
+  UpdateAttention();                            // the warnings may have been read
+}
+
+//! Master reads
+/*!
+Send the response, a legacy plant its text padded with 0 from the start on every read,
+an extended plant the length prefix and then the next chunk.
+\param pData storage for the bytes sent
+\param nMax bytes read by the master
+\return bytes sent
+*/
+static int Request(uint8_t * pData, int nMax)
+{
+  if ( bLegacy )
+  {
+    int   n = min(nResponseLength, nMax);
+    memcpy(pData, Response, n);
+    memset(pData + n, 0, nMax - n);
+    return nMax;
+  }
+  int           n = 0;
+  if ( ! bHeaderSent )
+  {
+    pData[n++] = I2C_LENGTH_FLAG | nResponseLength;
+    bHeaderSent = true;
+  }
+  while ( ( n < nMax ) && ( nResponseRead < nResponseLength ) )
+    pData[n++] = Response[nResponseRead++];
+  return n;
+}
+
+//! Step the model
+/*!
+Integrate the model up to the simulated time with the actuator pins of the controller.
+\param usecNow simulated time in usec
+*/
+static void Step(unsigned long usecNow)
+{
+  while ( usecNow - usecModel >= PLANT_STEP_MS * 1000 )
+  {
+    usecModel += PLANT_STEP_MS * 1000;
+    State.bIntake = bManualIntake || ( Native_Pin(PLANT_PIN_INTAKE) == HIGH );
+    State.bPump = bManualPump || ( Native_Pin(PLANT_PIN_PUMP) == HIGH );
+    State.bHeating = bManualHeating || ( Native_Pin(PLANT_PIN_HEATING) == HIGH );
+    int   nLapse = bTimeLapse ? PLANT_TIME_LAPSE : 1;
+    for ( int i = 0; i < nLapse; ++i )
+      Integrate(State, PLANT_STEP_MS / 1000.0);
+    msecPlant += PLANT_STEP_MS * nLapse;
+    nWarningsSeen |= State.nWarnings;
+    UpdateAttention();
+  }
+}
+
+//! callbacks of the plant
+static const NativeSlave PlantSlave = { Receive, Request, Step };
+
+// Plant setup
+bool Plant_Setup(bool bLegacyPlant)
+{
+  bLegacy = bLegacyPlant;
+  Reset();
+  usecModel = micros();
+  Native_SetPin(PLANT_PIN_DOOR_SWITCH, LOW);
+  return Native_AttachSlave(PLANT_I2C_ADDR, &PlantSlave);
+}
+
+//! columns of a trace
+enum TraceColumn
+{
+  TC_TIME, TC_DOOR, TC_LAUNDRY, TC_HEATING, TC_TEMPERATURE, TC_INTAKE, TC_PUMP,
+  TC_LEVEL, TC_ABSORBED, TC_DETERGENT, TC_RPM, TC_ENERGY, TC_WARNINGS, TC_COUNT
+};
+
+// Replay a recorded trace
+bool Plant_Replay(const char * pszFile)
+{
+  FILE *        pFile = fopen(pszFile, "r");
+  if ( pFile == nullptr )
+    return false;
+  static const TraceColumn Compared[] = { TC_TEMPERATURE, TC_LEVEL, TC_ABSORBED, TC_DETERGENT, TC_ENERGY };
+  static const char szCompared[] = "CAwok";
+  const int     COMPARED = sizeof(Compared) / sizeof(Compared[0]);
+  double        SumSquares[COMPARED] = { }, MaxError[COMPARED] = { };
+  double        Row[TC_COUNT], Previous[TC_COUNT] = { };
+  char          szLine[256];
+  int           nRows = 0;
+  PlantState    state;
+  while ( fgets(szLine, sizeof(szLine), pFile) != nullptr )
+  {
+    const char *  p = szLine;
+    int   nColumns = 0;
+    char *  pEnd;
+    while ( nColumns < TC_COUNT )
+    {
+      Row[nColumns] = strtod(p, &pEnd);
+      if ( pEnd == p )
+        break;
+      p = pEnd;
+      ++nColumns;
+    }
+    if ( nColumns < TC_COUNT )
+      continue;                                 // comment or empty
+    if ( nRows++ == 0 )
+    {                                           // start from the first sample
+      ResetState(state);
+      state.dWater = Row[TC_LEVEL];
+      state.dAbsorbed = Row[TC_ABSORBED];
+      state.dTemperature = Row[TC_TEMPERATURE];
+      state.dEnergy = Row[TC_ENERGY];
+      state.dDetergent = Row[TC_DETERGENT];
+      state.bDoorClosed = true;                 // the drum speed is taken from the trace
+      memcpy(Previous, Row, sizeof(Row));
+      continue;
+    }
+    state.nLaundry = (int)Previous[TC_LAUNDRY];
+    state.bHeating = ( Previous[TC_HEATING] != 0 );
+    state.bIntake = ( Previous[TC_INTAKE] != 0 );
+    state.bPump = ( Previous[TC_PUMP] != 0 );
+    state.nRpmSet = (int)Previous[TC_RPM];
+    state.dRpm = Previous[TC_RPM];
+    if ( Row[TC_DETERGENT] - Previous[TC_DETERGENT] > 5.0 )
+      state.dDetergent += lround(Row[TC_DETERGENT] - Previous[TC_DETERGENT]); // dosed
+    double  secInterval = Row[TC_TIME] - Previous[TC_TIME];
+    int     nSteps = max(1, (int)lround(secInterval * 1000.0 / PLANT_STEP_MS));
+    for ( int i = 0; i < nSteps; ++i )
+      Integrate(state, secInterval / nSteps);
+    double  Model[COMPARED] = { state.dTemperature, state.dWater, state.dAbsorbed, state.dDetergent + state.dSoftener, state.dEnergy };
+    for ( int i = 0; i < COMPARED; ++i )
+    {
+      double  dError = Model[i] - Row[Compared[i]];
+      SumSquares[i] += dError * dError;
+      MaxError[i] = max(MaxError[i], fabs(dError));
+    }
+    memcpy(Previous, Row, sizeof(Row));
+  }
+  fclose(pFile);
+
+  printf("# replay of %s, %d samples, %.0f s\n", pszFile, nRows, Previous[TC_TIME]);
+  printf("# value      RMS      max\n");
+  for ( int i = 0; i < COMPARED; ++i )
+    printf("%c   %10.3f %8.3f\n", szCompared[i], ( nRows > 1 ) ? sqrt(SumSquares[i] / ( nRows - 1 )) : 0.0, MaxError[i]);
+  return nRows > 1;
+}
+
+// Print a summary
+void Plant_PrintSummary(FILE * pFile)
+{
+  fprintf(pFile, "# plant %s, %.1f min plant time, %.1f kg water, %.3f kWh, warnings seen 0x%02X, %lu requests, %lu binary\n",
+          bLegacy ? "legacy" : "extended", msecPlant / 60000.0, State.dWaterUsed, State.dEnergy,
+          nWarningsSeen, nRequests, nBinaryRequests);
+}
@@ -0,0 +1,142 @@
+/*! \page Plant Plant Simulator
+Washing machine plant as simulated I²C slave of the native build, see \link Native Native Build \endlink.
+
+The plant Arduino exists as binary only, so the native build brings its own plant model.
+It answers the commands of the plant at PLANT_I2C_ADDR as the real one does, see \link Commands Manual Commands \endlink:
+T? t? C? D? L? I? A? H? w? k? P? o? r? W?, D=x L=n I=x H=x P=x O=n o=n r=n t=x V=x and R.
+Intake valve, pump and heating are read from the output pins of the controller as well, PLANT_PIN_INTAKE and so on.
+The door switch PLANT_PIN_DOOR_SWITCH is held closed.
+D=1 is the door closed, as written by the controller.
+
+By default the plant knows the extensions of the controller:
+length prefixed responses, several values per request, the change status "Z?" with the attention line PLANT_PIN_ATTENTION
+and the \link BinaryProtocol Binary Plant Protocol \endlink.
+As legacy plant (option -l) it behaves like the binary of the real plant:
+padded responses, one command per request and no extensions.
+
+Model, integrated every PLANT_STEP_MS, PLANT_TIME_LAPSE times faster in time lapse mode:
+- The intake fills PLANT_INFLOW, the pump drains PLANT_OUTFLOW, water above PLANT_LEVEL_MAX overflows.
+- The laundry absorbs PLANT_ABSORB kg water per kg at up to PLANT_ABSORB_RATE before the level rises.
+  Above PLANT_SPIN_RPM it gives the water back at PLANT_SPIN_RATE.
+- Detergent and softener leave the machine in proportion to the water pumped off.
+- The heater power falls linearly with the temperature, PLANT_HEATER_KW_PER_K * (PLANT_HEATER_T_MAX - C),
+  and is counted as energy k in kWh.
+  Water, laundry and drum take the heat, the machine loses PLANT_LOSS_KW_PER_K to the ambient,
+  fresh water comes with PLANT_T_INLET.
+- The drum follows its setpoint r with the time constant PLANT_DRUM_TAU_S, it stands while the door is open.
+
+The constants are fitted to the recorded traces WashingMachine/yt-plot.dat, a 30 °C program with 5 kg laundry,
+and wheiz.dat, heating 10 kg water to 60 °C.
+Replaying the actuators of a trace through the model with option -c gives the RMS deviation per value:
+<table border="0" width="80%">
+<tr><td> trace       </td><td> C in °C </td><td> A in kg </td><td> w in kg </td><td> o </td><td> k in kWh </td></tr>
+<tr><td> yt-plot.dat </td><td> 0.61 </td><td> 0.14 </td><td> 0.01 </td><td> 0.37 </td><td> 0.05 </td></tr>
+<tr><td> wheiz.dat   </td><td> 0.67 </td><td> 0.06 </td><td> 0    </td><td> 0    </td><td> 0.05 </td></tr>
+</table>
+
+Warnings W, one bit each, see PlantWarning:
+door open with water or turning drum, overflow, heating below PLANT_LEVEL_HEATER and temperature above PLANT_T_HOT.
+*/
+
+#ifndef PLANT_H
+#define PLANT_H
+
+// include Arduino HAL shim
+#include "Arduino.h"
+
+                                                // plant attributes
+//! I²C address of the plant
+const uint8_t   PLANT_I2C_ADDR = 10;
+//! controller output, water intake valve
+const uint8_t   PLANT_PIN_INTAKE = 2;
+//! controller output, water pump
+const uint8_t   PLANT_PIN_PUMP = 3;
+//! controller output, heating
+const uint8_t   PLANT_PIN_HEATING = 4;
+//! controller input, attention line of the plant, low active
+const uint8_t   PLANT_PIN_ATTENTION = 7;
+//! controller input, door switch, low while closed
+const uint8_t   PLANT_PIN_DOOR_SWITCH = 9;
+
+//! max drum speed, higher setpoints are limited
+const int       PLANT_RPM_MAX = 1400;
+//! max laundry in kg
+const int       PLANT_LAUNDRY_MAX = 10;
+//! model step in msec of plant time
+const unsigned long PLANT_STEP_MS = 100;
+//! speed up in time lapse mode t=1
+const int       PLANT_TIME_LAPSE = 10;
+//! intake flow in kg/s
+const double    PLANT_INFLOW = 0.15;
+//! pump flow in kg/s
+const double    PLANT_OUTFLOW = 0.1;
+//! max water level in kg, the rest overflows
+const double    PLANT_LEVEL_MAX = 16.0;
+//! min water level over the heater in kg
+const double    PLANT_LEVEL_HEATER = 0.5;
+//! water taken by the laundry in kg per kg
+const double    PLANT_ABSORB = 0.2;
+//! max absorption in kg/s
+const double    PLANT_ABSORB_RATE = 0.15;
+//! drum speed giving back the water of the laundry
+const double    PLANT_SPIN_RPM = 400.0;
+//! water given back while spinning in kg/s
+const double    PLANT_SPIN_RATE = 0.1;
+//! time constant of the drum in sec
+const double    PLANT_DRUM_TAU_S = 1.44;
+//! temperature at start in °C
+const double    PLANT_T_START = 18.0;
+//! temperature of fresh water in °C
+const double    PLANT_T_INLET = 14.6;
+//! ambient temperature in °C
+const double    PLANT_T_AMBIENT = 21.5;
+//! warning temperature in °C
+const double    PLANT_T_HOT = 95.0;
+//! heat capacity of water in kJ/(kg K)
+const double    PLANT_C_WATER = 4.186;
+//! heat capacity of the laundry in kJ/(kg K)
+const double    PLANT_C_LAUNDRY = 3.1;
+//! heat capacity of drum and tub in kJ/K
+const double    PLANT_C_DRUM = 1.3;
+//! heater power per K below PLANT_HEATER_T_MAX in kW/K
+const double    PLANT_HEATER_KW_PER_K = 0.078;
+//! temperature at which the heater power would be 0 in °C
+const double    PLANT_HEATER_T_MAX = 101.3;
+//! heat loss to the ambient in kW/K
+const double    PLANT_LOSS_KW_PER_K = 0.0184;
+
+//! warning bits of W
+enum PlantWarning
+{
+  PLANT_WARN_DOOR     = 0x01,                   ///< door open with water or turning drum
+  PLANT_WARN_OVERFLOW = 0x02,                   ///< water above PLANT_LEVEL_MAX
+  PLANT_WARN_DRY      = 0x04,                   ///< heating below PLANT_LEVEL_HEATER
+  PLANT_WARN_HOT      = 0x08                    ///< temperature above PLANT_T_HOT
+};
+
+                                                // plant prototypes
+//! Plant setup
+/*!
+Plant setup, attaches the plant as I²C slave and closes the door switch.
+\param bLegacyPlant true to behave like the binary of the real plant
+\return false if the slave cannot be attached
+*/
+extern bool Plant_Setup(bool bLegacyPlant);
+
+//! Replay a recorded trace
+/*!
+Replay the actuators of a recorded trace through the model and print the RMS deviation per value.
+The trace has one line per sample: time in sec, door, L, H, C, I, P, A, w, o, r, k, W.
+\param pszFile trace file
+\return false if the file cannot be read
+*/
+extern bool Plant_Replay(const char * pszFile);
+
+//! Print a summary
+/*!
+Print plant time, water used, heating energy, the warnings seen and the requests served.
+\param pFile output, typically stderr
+*/
+extern void Plant_PrintSummary(FILE * pFile);
+
+#endif // PLANT_H
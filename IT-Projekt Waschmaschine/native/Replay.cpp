@@ -0,0 +1,188 @@
+/* Replay of recorded I²C transactions, see \link Native Native Build \endlink
+*/
+
+// include containers, before the min and max macros of the Arduino HAL shim
+#include <vector>
+// include Arduino HAL shim
+#include "Arduino.h"
+// include native simulation control
+#include "Native.h"
+// include replay
+#include "Replay.h"
+// include I²C master
+#include "I2C_Master.h"
+
+//! record of the log
+struct ReplayRecord
+{
+  unsigned long long usecTime;                  ///< completion time, unwrapped
+  uint8_t       nSlaveNo;                       ///< slave number
+  bool          bLegacySlave;                   ///< slave without length prefix
+  uint8_t       nTag;                           ///< tag of the request
+  int           nResult;                        ///< response length or -3
+  unsigned long nResponseTime;                  ///< response time in usec
+  std::string   request;                        ///< request bytes
+  std::string   response;                       ///< response bytes
+};
+
+                                                // replay data
+//! records of the log
+static std::vector<ReplayRecord> Records;
+//! next record to hand over
+static size_t         nNext = 0;
+//! results of I2C_Replay(), equal, differing and not asked for
+static unsigned long  nEqual = 0, nDiffering = 0, nUnasked = 0;
+//! records dropped, queue full
+static unsigned long  nQueueFull = 0;
+//! records missing in the log by their sequence numbers
+static unsigned long  nMissing = 0;
+//! records with CRC errors
+static unsigned long  nCrcErrors = 0;
+//! state records taken
+static unsigned long  nStates = 0;
+
+// Arduino sketch, Controller.ino
+extern void TakeRecordedState(const uint8_t * pState, int nLength, unsigned long msecEarly);
+
+//! Update a CRC-16/CCITT-FALSE with one byte
+static uint16_t Crc16Update(uint16_t nCrc, uint8_t nByte)
+{
+  nCrc ^= (uint16_t)nByte << 8;
+  for ( int i = 0; i < 8; ++i )
+    nCrc = ( nCrc & 0x8000 ) ? ( nCrc << 1 ) ^ 0x1021 : ( nCrc << 1 );
+  return nCrc;
+}
+
+//! Read a value little endian
+static unsigned long GetLE(const uint8_t * p, int nBytes)
+{
+  unsigned long nValue = 0;
+  for ( int i = nBytes; i > 0; --i )
+    nValue = ( nValue << 8 ) | p[i-1];
+  return nValue;
+}
+
+//! Time a record is due
+/*!
+A state record is written by Task_100ms() of the controller after taking the results, when it may have queued requests.
+It is due I2C_TIMEOUT_MAX_US early, before the same task of the replay, so the replay asks from the same state already.
+*/
+static unsigned long long DueTime(const ReplayRecord & record)
+{
+  if ( record.nSlaveNo != 0 )
+    return record.usecTime;
+  return ( record.usecTime > I2C_TIMEOUT_MAX_US ) ? record.usecTime - I2C_TIMEOUT_MAX_US : 0;
+}
+
+// Replay setup
+bool Replay_Setup(const char * pszFile)
+{
+  FILE *        pFile = fopen(pszFile, "rb");
+  if ( pFile == nullptr )
+    return false;
+  std::string   log;
+  char          Buffer[4096];
+  size_t        n;
+  while ( ( n = fread(Buffer, 1, sizeof(Buffer), pFile) ) > 0 )
+    log.append(Buffer, n);
+  fclose(pFile);
+
+  const uint8_t * pLog = (const uint8_t *)log.data();
+  size_t        nSize = log.size();
+  unsigned long usecPrevious = 0;
+  unsigned long long usecTime = 0;
+  int           nSequence = -1;
+  for ( size_t nPos = 0; nPos + 2 + 1 + 2 <= nSize; ++nPos )
+  {
+    if ( ( pLog[nPos] != I2C_RECORD_SYNC1 ) || ( pLog[nPos+1] != I2C_RECORD_SYNC2 ) )
+      continue;                                 // text or telemetry
+    const uint8_t * p = pLog + nPos + 2;        // length
+    int   nLength = p[0];
+    if ( ( nLength < I2C_RECORD_OVERHEAD - 5 ) || ( nPos + 2 + 1 + nLength + 2 > nSize ) || ( p[1] != I2C_RECORD_VERSION ) )
+      continue;
+    uint16_t  nCrc = 0xFFFF;
+    for ( int i = 0; i < 1 + nLength; ++i )
+      nCrc = Crc16Update(nCrc, p[i]);
+    if ( nCrc != GetLE(p + 1 + nLength, 2) )
+    {
+      ++nCrcErrors;
+      continue;                                 // sync by chance or damaged, search on
+    }
+    ReplayRecord  record;
+    unsigned long usecRecord = GetLE(p + 3, 4);
+    usecTime += ( nSequence < 0 ) ? usecRecord : (uint32_t)( usecRecord - usecPrevious ); // micros() wraps on the Uno
+    usecPrevious = usecRecord;
+    record.usecTime = usecTime;
+    record.nSlaveNo = p[7] & 0x7F;
+    record.bLegacySlave = ( p[7] & 0x80 ) != 0;
+    record.nTag = p[8];
+    record.nResult = (int8_t)p[9];
+    record.nResponseTime = GetLE(p + 10, 4);
+    int   nRequestLength = p[14];
+    int   nResponseLength = nLength - ( I2C_RECORD_OVERHEAD - 5 ) - nRequestLength;
+    if ( ( nResponseLength < 0 ) || ( nResponseLength != max(record.nResult, 0) ) )
+    {
+      ++nCrcErrors;
+      continue;
+    }
+    record.request.assign((const char *)p + 15, nRequestLength);
+    record.response.assign((const char *)p + 15 + nRequestLength, nResponseLength);
+    if ( nSequence >= 0 )
+      nMissing += ( p[2] - nSequence - 1 ) & 0xFF;
+    nSequence = p[2];
+    if ( ( record.nSlaveNo != 0 ) || ( nRequestLength == 16 ) )
+      Records.push_back(record);                // a state record holds 16 bytes of slaves without length prefix
+    nPos += 2 + 1 + nLength + 2 - 1;            // behind the record
+  }
+  if ( Records.empty() )
+    return false;
+  I2C_SetReplay(true, (unsigned long)Records[0].usecTime);
+  return true;
+}
+
+// Time to the next record
+unsigned long Replay_Until(unsigned long usecStep)
+{
+  if ( nNext >= Records.size() )
+    return usecStep;
+  unsigned long long usecNow = Native_Time();
+  if ( DueTime(Records[nNext]) <= usecNow )
+    return usecStep;
+  return (unsigned long)min((unsigned long long)usecStep, DueTime(Records[nNext]) - usecNow);
+}
+
+// Hand due records to the I²C master
+void Replay_Step()
+{
+  while ( ( nNext < Records.size() ) && ( DueTime(Records[nNext]) <= Native_Time() ) )
+  {
+    const ReplayRecord & record = Records[nNext++];
+    if ( record.nSlaveNo == 0 )
+    {                                           // state record, the controller continues from there
+      unsigned long long usecNow = Native_Time();
+      I2C_ReplayState((const uint8_t *)record.request.data());
+      TakeRecordedState((const uint8_t *)record.response.data(), record.response.size(),
+                        ( record.usecTime > usecNow ) ? (unsigned long)( ( record.usecTime - usecNow ) / 1000 ) : 0);
+      ++nStates;
+      continue;
+    }
+    switch ( I2C_Replay(record.nSlaveNo, record.bLegacySlave, record.nTag,
+                        (const uint8_t *)record.request.data(), record.request.size(),
+                        (const uint8_t *)record.response.data(), record.nResult, record.nResponseTime) )
+    {
+    case 0:  ++nEqual;      break;
+    case 1:  ++nDiffering;  break;
+    case 2:  ++nUnasked;    break;
+    default: ++nQueueFull;  break;
+    }
+  }
+}
+
+// Print a summary
+void Replay_PrintSummary(FILE * pFile)
+{
+  fprintf(pFile, "# replay %lu of %lu records, %lu equal, %lu differing, %lu not asked for, %lu dropped, %lu missing in the log, %lu crc errors\n",
+          (unsigned long)nNext, (unsigned long)Records.size(), nEqual, nDiffering, nUnasked, nQueueFull, nMissing, nCrcErrors);
+  fprintf(pFile, "# replay %lu state records taken, %lu requests of the controller without record expired\n",
+          nStates, I2C_ReplayExpired());
+}
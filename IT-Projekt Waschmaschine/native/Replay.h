@@ -0,0 +1,55 @@
+/* Replay of recorded I²C transactions in the native build, see \link Native Native Build \endlink
+
+The log holds the records of the controller, see \link I2C_Master I2C Master \endlink,
+either as written by tools/i2c_capture.py or the raw output of the controller with text and telemetry between.
+The I²C master runs in replay mode without bus and plant,
+each recorded result is handed to it at its recorded time, when the controller fetches it as in the field.
+Requests of the controller the log holds no result for expire, they do not clog the queue.
+A state record, written when the recording starts, hands the controller what it had learned from the plant before,
+e.g. the protocol, the acknowledged setpoints and the values.
+The state of the wash program is not recorded, a recording started during a program replays as in the field
+only if the program got as far without the plant results before the recording.
+Inputs besides I²C are not recorded, the door switch is held closed and the attention line of the plant stays released.
+As long as the field run did not depend on them, the controller asks the same and a log recorded in the replay
+equals the captured one byte by byte.
+*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// include Arduino HAL shim
+#include "Arduino.h"
+
+                                                // replay prototypes
+//! Replay setup
+/*!
+Load a log and switch the I²C master to replay mode.
+\param pszFile log file
+\return false if the file cannot be read or holds no record
+*/
+extern bool Replay_Setup(const char * pszFile);
+
+//! Time to the next record
+/*!
+Time to advance the clock, up to the next record at most.
+\param usecStep time step
+\return time in usec, not more than usecStep
+*/
+extern unsigned long Replay_Until(unsigned long usecStep);
+
+//! Hand due records to the I²C master
+/*!
+Hand all records due at the simulated time to the I²C master, called by the main loop after every time step.
+*/
+extern void Replay_Step();
+
+//! Print a summary
+/*!
+Print the records handed over, how many requests of the controller equal the recorded ones,
+differ or were not asked for, records dropped because the queue was full,
+and the records missing in the log or with CRC errors.
+\param pFile output, typically stderr
+*/
+extern void Replay_PrintSummary(FILE * pFile);
+
+#endif // REPLAY_H
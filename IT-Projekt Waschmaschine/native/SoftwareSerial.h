@@ -0,0 +1,26 @@
+/* SoftwareSerial without a peer, see \link Native Native Build \endlink
+
+Output is dropped, nothing is ever received.
+*/
+
+#ifndef SOFTWARE_SERIAL_H
+#define SOFTWARE_SERIAL_H
+
+// include Arduino HAL shim
+#include "Arduino.h"
+
+//! SoftwareSerial, as far as used
+class SoftwareSerial : public Stream
+{
+public:
+  SoftwareSerial(uint8_t nRxPin, uint8_t nTxPin) { (void)nRxPin; (void)nTxPin; }
+  void begin(long nBaud) { (void)nBaud; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override { (void)c; return 1; }
+  using Print::write;
+  operator bool() { return true; }
+};
+
+#endif // SOFTWARE_SERIAL_H
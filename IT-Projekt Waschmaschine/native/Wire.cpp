@@ -0,0 +1,123 @@
+/* Wire master on simulated slaves
+*/
+
+// include Arduino HAL shim
+#include "Arduino.h"
+// include Wire
+#include "Wire.h"
+// include native simulation control
+#include "Native.h"
+
+//! attached slave
+struct SlaveEntry
+{
+  uint8_t             nAddress;                 ///< slave address
+  const NativeSlave * pSlave;                   ///< callbacks
+};
+
+                                                // Wire data
+//! attached slaves
+static SlaveEntry     Slaves[NATIVE_SLAVES_MAX];
+//! number of attached slaves
+static int            nSlaveCount = 0;
+
+TwoWire         Wire;
+
+//! Find the slave of an address
+static const NativeSlave * FindSlave(uint8_t nAddress)
+{
+  for ( int i = 0; i < nSlaveCount; ++i )
+    if ( Slaves[i].nAddress == nAddress )
+      return Slaves[i].pSlave;
+  return nullptr;                               // no acknowledge
+}
+
+// Attach a simulated I²C slave
+bool Native_AttachSlave(uint8_t nAddress, const NativeSlave * pSlave)
+{
+  if ( nSlaveCount >= NATIVE_SLAVES_MAX )
+    return false;
+  Slaves[nSlaveCount].nAddress = nAddress;
+  Slaves[nSlaveCount].pSlave = pSlave;
+  ++nSlaveCount;
+  return true;
+}
+
+// Step the simulated slaves
+void Native_StepSlaves()
+{
+  unsigned long usecNow = micros();
+  for ( int i = 0; i < nSlaveCount; ++i )
+    if ( Slaves[i].pSlave->pfnStep != nullptr )
+      Slaves[i].pSlave->pfnStep(usecNow);
+}
+
+//! Advance the clock by the bus time of a transfer
+void TwoWire::BusTime(int nBytes)
+{
+  // start, address and data with 9 clocks per byte, stop
+  Native_Advance( ( ( 1 + nBytes ) * 9UL + 2 ) * 1000000UL / nFrequency );
+}
+
+// Start a transmission
+void TwoWire::beginTransmission(uint8_t nAddress)
+{
+  nTxAddress = nAddress;
+  nTxLength = 0;
+}
+
+// Queue a byte
+size_t TwoWire::write(uint8_t c)
+{
+  if ( nTxLength >= WIRE_BUFFER_MAX )
+    return 0;                                   // buffer full
+  TxBuffer[nTxLength++] = c;
+  return 1;
+}
+
+// Queue bytes
+size_t TwoWire::write(const uint8_t * pData, size_t nLength)
+{
+  size_t        n = 0;
+  while ( ( n < nLength ) && write(pData[n]) )
+    ++n;
+  return n;
+}
+
+// Transmit
+uint8_t TwoWire::endTransmission(bool bStop)
+{
+  (void)bStop;
+  const NativeSlave * pSlave = FindSlave(nTxAddress);
+  if ( pSlave == nullptr )
+  {
+    BusTime(0);
+    return 2;                                   // address not acknowledged
+  }
+  BusTime(nTxLength);
+  if ( pSlave->pfnReceive != nullptr )
+    pSlave->pfnReceive(TxBuffer, nTxLength);
+  return 0;
+}
+
+// Read from a slave
+uint8_t TwoWire::requestFrom(int nAddress, int nQuantity, bool bStop)
+{
+  (void)bStop;
+  nRxLength = 0;
+  nRxRead = 0;
+  if ( nQuantity > WIRE_BUFFER_MAX )
+    nQuantity = WIRE_BUFFER_MAX;
+  const NativeSlave * pSlave = FindSlave((uint8_t)nAddress);
+  if ( pSlave == nullptr )
+  {
+    BusTime(0);
+    return 0;                                   // address not acknowledged
+  }
+  int   nSent = ( pSlave->pfnRequest != nullptr ) ? pSlave->pfnRequest(RxBuffer, nQuantity) : 0;
+  for ( int i = max(nSent, 0); i < nQuantity; ++i )
+    RxBuffer[i] = 0xFF;                         // released SDA reads as 1
+  nRxLength = nQuantity;
+  BusTime(nQuantity);
+  return nQuantity;
+}
@@ -0,0 +1,48 @@
+/* Wire master on simulated slaves, see \link Native Native Build \endlink
+
+A transfer is complete when the call returns, the clock advances by its bus time at the selected frequency.
+*/
+
+#ifndef WIRE_H
+#define WIRE_H
+
+// include Arduino HAL shim
+#include "Arduino.h"
+
+                                                // Wire attributes
+//! size of the transmit and receive buffer, as on the Uno
+const int       WIRE_BUFFER_MAX = 32;
+
+//! Arduino Wire, master mode
+class TwoWire : public Stream
+{
+public:
+  void begin() { }
+  void setClock(uint32_t nFrequency) { this->nFrequency = nFrequency; }
+  void beginTransmission(uint8_t nAddress);
+  void beginTransmission(int nAddress) { beginTransmission((uint8_t)nAddress); }
+  uint8_t endTransmission(bool bStop = true);
+  uint8_t endTransmission(uint8_t bStop) { return endTransmission(bStop != 0); }
+  uint8_t requestFrom(int nAddress, int nQuantity, bool bStop = true);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t * pData, size_t nLength) override;
+  using Print::write;
+  int available() override { return nRxLength - nRxRead; }
+  int read() override { return ( nRxRead < nRxLength ) ? RxBuffer[nRxRead++] : -1; }
+  int peek() override { return ( nRxRead < nRxLength ) ? RxBuffer[nRxRead] : -1; }
+
+private:
+  void BusTime(int nBytes);
+
+  uint32_t      nFrequency = 100000;            ///< bus frequency in Hz
+  uint8_t       nTxAddress = 0;                 ///< address of the transmission
+  uint8_t       TxBuffer[WIRE_BUFFER_MAX];      ///< bytes to write
+  int           nTxLength = 0;                  ///< number of bytes to write
+  uint8_t       RxBuffer[WIRE_BUFFER_MAX];      ///< bytes read
+  int           nRxLength = 0;                  ///< number of bytes read
+  int           nRxRead = 0;                    ///< bytes taken by read()
+};
+
+extern TwoWire Wire;
+
+#endif // WIRE_H
@@ -0,0 +1,180 @@
+/* Main loop of the native build, see \link Native Native Build \endlink
+*/
+
+// include Arduino HAL shim
+#include "Arduino.h"
+// include native simulation control
+#include "Native.h"
+// include door sensor
+#include "DoorSensor.h"
+// include plant simulator
+#include "Plant.h"
+// include replay of recorded I²C transactions
+#include "Replay.h"
+// include host time and options
+#include <time.h>
+#include <unistd.h>
+
+#ifndef PIO_UNIT_TESTING                        // the unit tests in test bring their own main()
+
+//! one line of the input script
+struct ScriptLine
+{
+  unsigned long msecAt;                         ///< simulated time to type it
+  std::string   text;                           ///< command with newline
+};
+
+                                                // native main data
+//! input script, sorted by time
+static ScriptLine *   pScript = nullptr;
+//! number of script lines
+static int            nScriptLines = 0;
+
+// Arduino sketch, Controller.ino
+extern void setup();
+extern void loop();
+
+//! Load the input script
+/*!
+Load the typed commands, one per line, "@msec command" delays a command to that time.
+Lines without time follow the previous line at once.
+\param pszFile file name
+\return false if the file cannot be read
+*/
+static bool LoadScript(const char * pszFile)
+{
+  FILE *        pFile = fopen(pszFile, "r");
+  if ( pFile == nullptr )
+    return false;
+  static ScriptLine Lines[256];
+  char          szLine[128];
+  unsigned long msecAt = 0;
+  while ( ( nScriptLines < 256 ) && ( fgets(szLine, sizeof(szLine), pFile) != nullptr ) )
+  {
+    const char *  p = szLine;
+    if ( *p == '@' )
+    {                                           // time stamp
+      char *  pEnd;
+      msecAt = strtoul(p+1, &pEnd, 10);
+      p = pEnd;
+      while ( *p == ' ' )
+        ++p;
+    }
+    if ( ( *p == 0 ) || ( *p == '\n' ) || ( *p == '\r' ) )
+      continue;                                 // time only or empty
+    Lines[nScriptLines].msecAt = msecAt;
+    Lines[nScriptLines].text = p;
+    if ( Lines[nScriptLines].text.back() != '\n' )
+      Lines[nScriptLines].text += '\n';
+    ++nScriptLines;
+  }
+  fclose(pFile);
+  pScript = Lines;
+  return true;
+}
+
+//! Native main
+/*!
+Attach the plant, run setup() once, then loop() until the simulated run time is over.
+After every call of loop() the clock advances by the time step,
+the door is sampled every msec and the simulated slaves are stepped.
+In a replay the recorded I²C results are handed over instead, each at its recorded time.
+*/
+int main(int argc, char * argv[])
+{
+  double        secRun = 60.0;
+  unsigned long usecStep = NATIVE_STEP_US;
+  bool          bPlant = true;
+  bool          bLegacyPlant = false;
+  bool          bReplay = false;
+  int           nOption;
+  while ( ( nOption = getopt(argc, argv, "t:s:i:qlnc:r:") ) != -1 )
+  {
+    switch ( nOption )
+    {
+    case 't':
+      secRun = atof(optarg);
+      break;
+    case 's':
+      usecStep = strtoul(optarg, nullptr, 10);
+      if ( usecStep == 0 )
+        usecStep = 1;                           // time has to go on
+      break;
+    case 'i':
+      if ( ! LoadScript(optarg) )
+      {
+        fprintf(stderr, "cannot read %s\n", optarg);
+        return 1;
+      }
+      break;
+    case 'q':
+      Native_SerialQuiet(true);
+      break;
+    case 'l':
+      bLegacyPlant = true;
+      break;
+    case 'n':
+      bPlant = false;
+      break;
+    case 'c':
+      if ( ! Plant_Replay(optarg) )
+      {
+        fprintf(stderr, "cannot replay %s\n", optarg);
+        return 1;
+      }
+      return 0;                                 // calibration only
+    case 'r':
+      if ( ! Replay_Setup(optarg) )
+      {
+        fprintf(stderr, "no records in %s\n", optarg);
+        return 1;
+      }
+      bReplay = true;
+      bPlant = false;                           // the results come from the log
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-t sec] [-s usec] [-i script] [-q] [-l] [-n] [-c trace] [-r log]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  clock_t       nHostStart = clock();
+  unsigned long long usecEnd = (unsigned long long)( secRun * 1e6 );
+  unsigned long long nLoops = 0;
+  unsigned long msecSampled = 0;
+  int           nNextLine = 0;
+
+  if ( bPlant )
+    Plant_Setup(bLegacyPlant);
+  if ( bReplay )
+    Native_SetPin(PLANT_PIN_DOOR_SWITCH, LOW);  // door closed, as with the plant
+  setup();
+  while ( Native_Time() < usecEnd )
+  {
+    while ( ( nNextLine < nScriptLines ) && ( pScript[nNextLine].msecAt <= millis() ) )
+      Native_SerialInput(pScript[nNextLine++].text.c_str());
+    loop();
+    ++nLoops;
+    Native_Advance(bReplay ? Replay_Until(usecStep) : usecStep); // a record exactly at its time
+    while ( msecSampled < millis() )
+    {                                           // as the Timer0 compare interrupt does on the Uno
+      Door_Sample();
+      ++msecSampled;
+    }
+    Native_StepSlaves();
+    if ( bReplay )
+      Replay_Step();
+  }
+  fflush(stdout);
+
+  double        secHost = (double)( clock() - nHostStart ) / CLOCKS_PER_SEC;
+  fprintf(stderr, "# simulated %.1f s in %.2f s host time, %.0f times real time, %llu loops\n",
+          Native_Time() / 1e6, secHost, ( secHost > 0 ) ? Native_Time() / 1e6 / secHost : 0.0, nLoops);
+  if ( bPlant )
+    Plant_PrintSummary(stderr);
+  if ( bReplay )
+    Replay_PrintSummary(stderr);
+  return 0;
+}
+
+#endif // PIO_UNIT_TESTING
@@ -0,0 +1,114 @@
+/* Compact binary request/response frames
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include binary protocol
+#include "BinaryProtocol.h"
+
+// Start a frame
+int Binary_Begin(uint8_t * pFrame, uint8_t nVersion /*=BINARY_VERSION*/)
+{
+  pFrame[0] = BINARY_MAGIC | ( nVersion & BINARY_VERSION_MASK );
+  return 1;
+}
+
+// Add a read request
+int Binary_AddRead(uint8_t * pFrame, int nLength, int nMax, char cId)
+{
+  if ( nLength + 2 > nMax )
+    return -1;                                  // full
+  pFrame[nLength++] = cId;
+  pFrame[nLength++] = 0;                        // no value, read
+  return nLength;
+}
+
+// Add a value
+int Binary_AddValue(uint8_t * pFrame, int nLength, int nMax, char cId, long nValue, uint8_t nSize)
+{
+  if ( nLength + 2 + nSize > nMax )
+    return -1;                                  // full
+  pFrame[nLength++] = cId;
+  pFrame[nLength++] = nSize;
+  for ( uint8_t i = 0; i < nSize; ++i )
+  {                                             // little endian
+    pFrame[nLength++] = (uint8_t)nValue;
+    nValue >>= 8;
+  }
+  return nLength;
+}
+
+// Convert an ASCII request
+int Binary_FromText(const char * pszRequest, uint8_t * pFrame, int nMax, uint8_t nVersion /*=BINARY_VERSION*/)
+{
+  int           nLength = Binary_Begin(pFrame, nVersion);
+  const char *  p = pszRequest;
+  while ( ( nLength > 0 ) && ( *p != 0 ) )
+  {
+    if ( p[1] == '?' )
+    {
+      nLength = Binary_AddRead(pFrame, nLength, nMax, p[0]);
+      p += 2;
+    }
+    else if ( p[1] == '=' )
+    {
+      char *  pEnd;
+      long    nValue = strtol(p+2, &pEnd, 10);
+      if ( pEnd == p+2 )
+        return -1;                              // no number
+      nLength = Binary_AddValue(pFrame, nLength, nMax, p[0], nValue, 2);
+      p = pEnd;
+    }
+    else
+      return -1;                                // e.g. "R", stays ASCII
+  }
+  return nLength;
+}
+
+// Version of a frame
+uint8_t Binary_Version(const uint8_t * pFrame, int nLength)
+{
+  if ( ( nLength < 1 ) || ( ( pFrame[0] & ~BINARY_VERSION_MASK ) != BINARY_MAGIC ) )
+    return 0;                                   // ASCII
+  return pFrame[0] & BINARY_VERSION_MASK;
+}
+
+// Next entry of a frame
+int Binary_Next(const uint8_t * pFrame, int nLength, int nPos, char * pcId, long * pnValue)
+{
+  while ( nPos < nLength )
+  {
+    if ( nPos + 2 > nLength )
+      return -1;                                // truncated
+    char    cId = pFrame[nPos];
+    uint8_t nSize = pFrame[nPos+1];
+    nPos += 2;
+    if ( nPos + nSize > nLength )
+      return -1;                                // truncated
+    if ( ( nSize != 0 ) && ( nSize != 1 ) && ( nSize != 2 ) && ( nSize != 4 ) )
+    {
+      nPos += nSize;                            // unknown, skip it
+      continue;
+    }
+    long    nValue = 0;
+    for ( uint8_t i = nSize; i > 0; --i )
+      nValue = ( nValue << 8 ) | pFrame[nPos+i-1];
+    if ( ( nSize > 0 ) && ( nSize < sizeof(long) ) && ( pFrame[nPos+nSize-1] & 0x80 ) )
+      nValue -= 1L << ( 8 * nSize );            // sign extension
+    *pcId = cId;
+    *pnValue = nValue;
+    return nPos + nSize;
+  }
+  return 0;                                     // end of frame
+}
+
+// Parse the version answer
+uint8_t Binary_ParseVersion(const char * pszResponse)
+{
+  if ( ( pszResponse[0] != BINARY_QUERY[0] ) || ( pszResponse[1] != '=' ) )
+    return 0;                                   // old plant
+  int   nVersion = atoi(pszResponse+2);
+  if ( nVersion <= 0 )
+    return 0;
+  return min(nVersion, (int)BINARY_VERSION);
+}
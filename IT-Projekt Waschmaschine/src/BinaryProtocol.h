@@ -0,0 +1,131 @@
+/*! \page BinaryProtocol Binary Plant Protocol
+Compact binary request/response frames for the plant link.
+
+The ASCII protocol costs formatting and parsing of every value on both sides, e.g. atof() for "C=23.45".
+The binary protocol carries the same registers as scaled integers, little endian, without any text conversion.
+
+A frame starts with BINARY_MAGIC + version, a byte no ASCII request or response starts with,
+followed by entries of register id, value size and value:
+<table border="0" width="80%">
+<tr><td> 0xB1 </td><td> frame start, protocol version 1 </td></tr>
+<tr><td> id   </td><td> register id, the command character, e.g. 'C' </td></tr>
+<tr><td> size </td><td> value size in bytes, 0 for a read request, 1, 2 or 4 otherwise </td></tr>
+<tr><td> value </td><td> signed, little endian </td></tr>
+</table>
+A request holds reads ("C?" is 'C' 0) and writes ("r=800" is 'r' 2 0x20 0x03).
+The response holds an entry for every read with its value and for every write with the value taken, the acknowledge.
+An entry with an unknown size is skipped, so newer registers do not break older readers.
+
+Registers, the plant answers reads with the fixed size given here:
+<table border="0" width="80%">
+<tr><td> T </td><td> 4 </td><td> simulation time in 0.01 min </td></tr>
+<tr><td> C </td><td> 2 </td><td> temperature in 0.01 °C </td></tr>
+<tr><td> A, w </td><td> 2 </td><td> water level, water in laundry in g </td></tr>
+<tr><td> D, I, H, P </td><td> 1 </td><td> door, valve, heating, pump </td></tr>
+<tr><td> W, r, L, O, o </td><td> 2 </td><td> warnings, drum speed, laundry, detergent, softener </td></tr>
+<tr><td> k </td><td> 2 </td><td> heating energy in Wh </td></tr>
+<tr><td> Z </td><td> 2 </td><td> change status </td></tr>
+</table>
+
+Negotiation: the master sends the ASCII request BINARY_QUERY "B?".
+A plant knowing the binary protocol answers "B=n" with its version, the master then uses min(n, BINARY_VERSION).
+Older plants answer anything else, the master stays with ASCII.
+A binary request answered in ASCII drops the master back to ASCII as well.
+Typed commands always go as ASCII, the plant tells both apart by the first byte.
+
+The module is used by the Uno and the ESP32 controller, both copies have to be kept identical.
+*/
+
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // binary protocol attributes
+//! protocol version of this implementation
+const uint8_t   BINARY_VERSION = 1;
+//! frame start without version, the upper bits of the first byte
+const uint8_t   BINARY_MAGIC = 0xB0;
+//! mask of the version in the first byte
+const uint8_t   BINARY_VERSION_MASK = 0x0F;
+//! ASCII request for the version of the plant
+const char      BINARY_QUERY[] = "B?";
+
+                                                // binary protocol prototypes
+//! Start a frame
+/*!
+Start a frame with BINARY_MAGIC + version.
+\param pFrame frame storage
+\param nVersion protocol version
+\return frame length
+*/
+extern int Binary_Begin(uint8_t * pFrame, uint8_t nVersion = BINARY_VERSION);
+
+//! Add a read request
+/*!
+Add a read request for a register.
+\param pFrame frame
+\param nLength current frame length
+\param nMax size of the frame storage
+\param cId register id
+\return new frame length, -1 if the frame is full
+*/
+extern int Binary_AddRead(uint8_t * pFrame, int nLength, int nMax, char cId);
+
+//! Add a value
+/*!
+Add a register value, a write or the value of a response.
+\param pFrame frame
+\param nLength current frame length
+\param nMax size of the frame storage
+\param cId register id
+\param nValue value
+\param nSize value size in bytes, 1, 2 or 4
+\return new frame length, -1 if the frame is full
+*/
+extern int Binary_AddValue(uint8_t * pFrame, int nLength, int nMax, char cId, long nValue, uint8_t nSize);
+
+//! Convert an ASCII request
+/*!
+Convert an ASCII request of reads "k?" and integer writes "k=n", e.g. "T?C?" or "r=800", into a frame.
+Writes are sent with 2 bytes.
+\param pszRequest ASCII request
+\param pFrame frame storage
+\param nMax size of the frame storage
+\param nVersion protocol version
+\return frame length, -1 if the request does not fit or is no plain read or write
+*/
+extern int Binary_FromText(const char * pszRequest, uint8_t * pFrame, int nMax, uint8_t nVersion = BINARY_VERSION);
+
+//! Version of a frame
+/*!
+Protocol version of a frame.
+\param pFrame frame
+\param nLength frame length
+\return version, 0 if no binary frame, e.g. an ASCII response
+*/
+extern uint8_t Binary_Version(const uint8_t * pFrame, int nLength);
+
+//! Next entry of a frame
+/*!
+Get the next entry of a frame, entries with an unknown size are skipped.
+Start with position 1, behind the frame start.
+\param pFrame frame
+\param nLength frame length
+\param nPos position of the entry
+\param pcId storage for the register id
+\param pnValue storage for the value, sign extended, 0 for a read request
+\return position of the following entry, 0 at the end of the frame, -1 if truncated
+*/
+extern int Binary_Next(const uint8_t * pFrame, int nLength, int nPos, char * pcId, long * pnValue);
+
+//! Parse the version answer
+/*!
+Parse the answer "B=n" to BINARY_QUERY.
+\param pszResponse ASCII response
+\return version to use, 0 for ASCII
+*/
+extern uint8_t Binary_ParseVersion(const char * pszResponse);
+
+#endif // BINARY_PROTOCOL_H
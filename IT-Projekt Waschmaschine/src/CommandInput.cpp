@@ -0,0 +1,96 @@
+/* Line framed command input
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include command input
+#include "CommandInput.h"
+
+                                                // command queue data
+//! ring buffer with zero terminated commands
+static char           CommandQueue[CMD_QUEUE_SIZE];
+//! write position
+static int            nQueueHead = 0;
+//! read position
+static int            nQueueTail = 0;
+//! bytes in use
+static int            nQueueUsed = 0;
+//! dropped commands
+static unsigned int   nCommandsDropped = 0;
+
+//! Append a complete command to the queue
+/*!
+Append a complete command to the queue, as a whole or not at all.
+\param pszCommand command
+\param nLength command length
+*/
+static void AppendCommand(const char * pszCommand, int nLength)
+{
+  if ( nLength + 1 > CMD_QUEUE_SIZE - nQueueUsed )
+  {
+    ++nCommandsDropped;                         // queue full
+    return;
+  }
+  for ( int i = 0; i <= nLength; ++i )          // including trailing 0
+  {
+    CommandQueue[nQueueHead] = pszCommand[i];
+    if ( ++nQueueHead >= CMD_QUEUE_SIZE )
+      nQueueHead = 0;
+  }
+  nQueueUsed += nLength + 1;
+}
+
+// Collect characters from a source
+void Command_Poll(Stream & in, LineAssembler & line)
+{
+  while ( in.available() > 0 )
+  {
+    int   ch = in.read();
+    if ( ch < 0 )
+      break;
+    if ( ( ch == '\n' ) || ( ch == '\r' ) )
+    {                                           // line end
+      if ( line.bOverlong )
+        ++nCommandsDropped;
+      else if ( line.nLength > 0 )
+      {
+        line.szLine[line.nLength] = 0;
+        AppendCommand(line.szLine, line.nLength);
+      }
+      line.nLength = 0;
+      line.bOverlong = false;
+    }
+    else if ( line.nLength < CMD_LENGTH_MAX )
+      line.szLine[line.nLength++] = ch;         // collect characters
+    else
+      line.bOverlong = true;
+  }
+}
+
+// Take the oldest command from the queue
+bool Command_Take(char szCommand[], int nCommandLengthMax)
+{
+  *szCommand = 0;                               // initially empty result
+  if ( nQueueUsed == 0 )
+    return false;
+
+  int   nLength = 0;
+  char  ch;
+  do
+  {
+    ch = CommandQueue[nQueueTail];
+    if ( ++nQueueTail >= CMD_QUEUE_SIZE )
+      nQueueTail = 0;
+    --nQueueUsed;
+    if ( nLength < nCommandLengthMax-1 )
+      szCommand[nLength++] = ch;
+  } while ( ch != 0 );
+  szCommand[nCommandLengthMax-1] = 0;           // make sure there is a trailing 0
+  return true;
+}
+
+// Number of dropped commands
+unsigned int Command_Dropped()
+{
+  return nCommandsDropped;
+}
@@ -0,0 +1,64 @@
+/*! \page CommandInput Command Input
+Line framed command input with a command queue.
+
+Characters from the USB COM port and from the ESP are collected without waiting
+by one line assembler per source. A command is complete with '\\n' or '\\r', empty lines are ignored.
+Complete commands go to one common queue in arrival order.
+
+The queue is a fixed ring buffer of CMD_QUEUE_SIZE bytes holding the commands zero terminated,
+so many short commands fit into it.
+Lines longer than CMD_LENGTH_MAX and commands not fitting into the queue are dropped and counted.
+
+Command_Poll() has to be called often enough to keep the serial receive buffers from overflowing,
+at 115200 Baud the 64 byte buffer of the Arduino UNO is full after about 5 msec.
+
+There is no flow control, the sender has to keep to the rate the controller takes the commands.
+Task_100ms() takes them only while the I²C master has a slot free for a plant command,
+which is about every other call as one slot is kept for safety writes and one serves the poll.
+So commands for the plant, and local commands queued behind them, are taken at about 4 to 5 per second.
+A burst beyond that is buffered up to CMD_QUEUE_SIZE bytes, e.g. 42 commands like "C?",
+the commands coming on top are dropped and reported as "# commands dropped=n" by Task_1s().
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // command input attributes
+//! max command length without trailing 0
+const int       CMD_LENGTH_MAX = 31;
+//! command queue size in bytes
+const int       CMD_QUEUE_SIZE = 128;
+
+//! line assembler, one per source
+struct LineAssembler
+{
+  char          szLine[CMD_LENGTH_MAX+1];       ///< line under construction
+  uint8_t       nLength;                        ///< current length
+  bool          bOverlong;                      ///< line too long, drop it at its end
+};
+
+                                                // command input prototypes
+//! Collect characters from a source
+/*!
+Collect all characters available from a source, never waits.
+Complete lines are appended to the command queue.
+\param in source, e.g. Serial
+\param line line assembler of this source
+*/
+extern void Command_Poll(Stream & in, LineAssembler & line);
+
+//! Take the oldest command from the queue
+/*!
+Take the oldest command from the queue.
+\param szCommand storage for the command
+\param nCommandLengthMax size of szCommand
+\return true if a command has been taken
+*/
+extern bool Command_Take(char szCommand[], int nCommandLengthMax);
+
+//! Number of dropped commands
+/*!
+Number of commands dropped because they were too long or the queue was full.
+\return dropped commands since start
+*/
+extern unsigned int Command_Dropped();
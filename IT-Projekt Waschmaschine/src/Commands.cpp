@@ -0,0 +1,101 @@
+/* Compile time command descriptor table
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include command table
+#include "Commands.h"
+// include fixed point values
+#include "FixedPoint.h"
+
+// Get a descriptor from flash
+void Command_Get(const CommandDesc * pTable, int nIndex, CommandDesc & desc)
+{
+  memcpy_P(&desc, &pTable[nIndex], sizeof(desc));
+}
+
+// Look up a key
+int Command_Find(const int8_t * pLookup, char cKey)
+{
+  return (int8_t)pgm_read_byte(&pLookup[cKey & 0x7F]);
+}
+
+// Store a value text in the target variable
+void Command_Store(const CommandDesc & desc, const char * pszValue)
+{
+  switch ( desc.nType )
+  {
+  case VT_BOOL:
+  case VT_INT:
+    Command_StoreValue(desc, atoi(pszValue));
+    break;
+  case VT_FIXED3:
+    Command_StoreValue(desc, ParseFixed(pszValue, 3));
+    break;
+  default:
+    Command_StoreValue(desc, ParseFixed(pszValue, 2));
+    break;
+  }
+}
+
+// Store a scaled value in the target variable
+void Command_StoreValue(const CommandDesc & desc, long nValue)
+{
+  switch ( desc.nType )
+  {
+  case VT_BOOL:
+    *(bool *)desc.pTarget = ( nValue != 0 );
+    break;
+  case VT_LFIXED2:
+    *(long *)desc.pTarget = nValue;
+    break;
+  default:
+    *(int *)desc.pTarget = nValue;
+    break;
+  }
+}
+
+// Get the scaled value of the target variable
+long Command_Value(const CommandDesc & desc)
+{
+  switch ( desc.nType )
+  {
+  case VT_BOOL:
+    return *(bool *)desc.pTarget ? 1 : 0;
+  case VT_LFIXED2:
+    return *(long *)desc.pTarget;
+  default:
+    return *(int *)desc.pTarget;
+  }
+}
+
+// Create the poll of a descriptor
+void Command_Format(const CommandDesc & desc, char szCommand[])
+{
+  szCommand[0] = desc.cKey;
+  szCommand[1] = '?';
+  szCommand[2] = 0;
+}
+
+// Max response length of a descriptor
+int Command_ResponseLength(const CommandDesc & desc)
+{
+  switch ( desc.nType )
+  {
+  case VT_BOOL:
+    return 2 + 1;                               // "k=1"
+  case VT_INT:
+    return 2 + 6;                               // "k=-32768"
+  case VT_FIXED2:
+  case VT_FIXED3:
+    return 2 + 7;                               // "k=-327.68", "k=-32.768"
+  default:
+    return 2 + 9;                               // "k=999999.99"
+  }
+}
+
+// See if a character separates values
+bool Command_IsSeparator(char ch)
+{
+  return ( ch == ';' ) || ( ch == ',' ) || ( ch == ' ' ) || ( ch == '\t' ) || ( ch == '\r' ) || ( ch == '\n' );
+}
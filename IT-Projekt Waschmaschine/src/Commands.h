@@ -0,0 +1,166 @@
+/*! \page CommandTable Command Table
+Compile time command descriptor table.
+
+All commands known to the controller are described once in a table of CommandDesc,
+see Commands[] in Controller.ino:
+key, direction, value type, target variable or pin and refresh intervals per program phase.
+The response parser, the digital IO handler and the poll scheduler are all driven by this table,
+see \link Polling Poll Scheduler \endlink.
+
+A lookup table indexed by the key character is generated from the descriptor table at compile time
+with CMD_LOOKUP_TABLE(), so finding the descriptor for a response is a single array access.
+Both tables are stored in flash.
+
+Directions:
+<table border="0" width="80%">
+<tr><td> CMD_POLL </td><td> value of the plant, polled with "k?", the response "k=value" is stored </td></tr>
+<tr><td> CMD_IO   </td><td> digital output of the controller, "k=0" or "k=1" is done locally, never polled </td></tr>
+</table>
+
+Several polls can be batched into one request, e.g. "T?C?A?".
+The plant answers them in one response, e.g. "T=12.34;C=23.45;A=1.300",
+values separated by ';', ',' or blanks, see Command_IsSeparator().
+With the \link BinaryProtocol Binary Plant Protocol \endlink the values come as scaled integers
+and are stored with Command_StoreValue() without any parsing.
+*/
+
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // command table attributes
+//! command directions
+enum CommandDirection { CMD_POLL, CMD_IO };
+
+//! program phases with their own refresh intervals
+enum PollPhase
+{
+  PH_IDLE,                                      ///< no wash program running
+  PH_FILL,                                      ///< filling in water
+  PH_HEAT,                                      ///< heating up
+  PH_WASH,                                      ///< tumbling, holding, dosing
+  PH_DRAIN,                                     ///< draining and spinning
+  PH_COUNT                                      ///< number of phases
+};
+
+//! refresh interval: never poll
+const uint8_t   POLL_NEVER = 0;
+//! refresh interval: poll once per wash program
+const uint8_t   POLL_ONCE = 255;
+//! time unit of refresh intervals in msec, one I²C transaction
+const unsigned int POLL_TICK_MS = 100;
+
+//! value types of the target variables
+enum CommandType
+{
+  VT_BOOL,                                      ///< bool
+  VT_INT,                                       ///< int
+  VT_FIXED2,                                    ///< int in 1/100
+  VT_FIXED3,                                    ///< int in 1/1000
+  VT_LFIXED2                                    ///< long in 1/100
+};
+
+//! command descriptor
+struct CommandDesc
+{
+  char          cKey;                           ///< command character
+  uint8_t       nDirection;                     ///< see CommandDirection
+  uint8_t       nType;                          ///< see CommandType
+  void *        pTarget;                        ///< target variable, nullptr for CMD_IO
+  uint8_t       nPin;                           ///< output pin for CMD_IO
+  uint8_t       Refresh[PH_COUNT];              ///< refresh interval per PollPhase in POLL_TICK_MS, POLL_NEVER or POLL_ONCE
+};
+
+//! Find the index of a key at compile time
+/*!
+Find the index of a key in a descriptor table at compile time.
+\param Table descriptor table
+\param cKey key to find
+\param i start index
+\return index, -1 if not found
+*/
+template <int N>
+constexpr int8_t CommandIndexOf(const CommandDesc (&Table)[N], char cKey, int i = 0)
+{
+  return ( i >= N ) ? -1 : ( Table[i].cKey == cKey ) ? i : CommandIndexOf(Table, cKey, i + 1);
+}
+
+//! \cond
+#define CMD_LOOKUP_1(t, c)   CommandIndexOf(t, (char)(c))
+#define CMD_LOOKUP_4(t, c)   CMD_LOOKUP_1(t, c), CMD_LOOKUP_1(t, c+1), CMD_LOOKUP_1(t, c+2), CMD_LOOKUP_1(t, c+3)
+#define CMD_LOOKUP_16(t, c)  CMD_LOOKUP_4(t, c), CMD_LOOKUP_4(t, c+4), CMD_LOOKUP_4(t, c+8), CMD_LOOKUP_4(t, c+12)
+//! \endcond
+//! initializer of a 128 entry lookup table key character -> descriptor index
+#define CMD_LOOKUP_TABLE(t)  CMD_LOOKUP_16(t, 0),  CMD_LOOKUP_16(t, 16), CMD_LOOKUP_16(t, 32), CMD_LOOKUP_16(t, 48), \
+                             CMD_LOOKUP_16(t, 64), CMD_LOOKUP_16(t, 80), CMD_LOOKUP_16(t, 96), CMD_LOOKUP_16(t, 112)
+
+                                                // command table prototypes
+//! Get a descriptor from flash
+/*!
+Get a descriptor from a table in flash.
+\param pTable descriptor table in flash
+\param nIndex index in the table
+\param desc storage for the descriptor
+*/
+extern void Command_Get(const CommandDesc * pTable, int nIndex, CommandDesc & desc);
+
+//! Look up a key
+/*!
+Look up a key in a lookup table in flash.
+\param pLookup lookup table created with CMD_LOOKUP_TABLE()
+\param cKey key character
+\return descriptor index, -1 if unknown
+*/
+extern int Command_Find(const int8_t * pLookup, char cKey);
+
+//! Store a value text in the target variable
+/*!
+Store a value text in the target variable of a descriptor.
+\param desc descriptor
+\param pszValue value text, the part after '='
+*/
+extern void Command_Store(const CommandDesc & desc, const char * pszValue);
+
+//! Store a scaled value in the target variable
+/*!
+Store a value already scaled to the target type, e.g. from a binary response.
+\param desc descriptor
+\param nValue value, in 1/100 for VT_FIXED2 and VT_LFIXED2, in 1/1000 for VT_FIXED3
+*/
+extern void Command_StoreValue(const CommandDesc & desc, long nValue);
+
+//! Get the scaled value of the target variable
+/*!
+Get the value of the target variable as Command_StoreValue() takes it.
+\param desc descriptor
+\return value, in 1/100 for VT_FIXED2 and VT_LFIXED2, in 1/1000 for VT_FIXED3
+*/
+extern long Command_Value(const CommandDesc & desc);
+
+//! Create the poll of a descriptor
+/*!
+Create the poll "k?" of a CMD_POLL descriptor.
+\param desc descriptor
+\param szCommand storage for the command, at least 3 bytes
+*/
+extern void Command_Format(const CommandDesc & desc, char szCommand[]);
+
+//! Max response length of a descriptor
+/*!
+Max length of the response "k=value" of a descriptor, without separator.
+\param desc descriptor
+\return number of characters
+*/
+extern int Command_ResponseLength(const CommandDesc & desc);
+
+//! See if a character separates values
+/*!
+See if a character separates the values of a batched response.
+\param ch character
+\return true for ';', ',', blank, tab and line ends
+*/
+extern bool Command_IsSeparator(char ch);
+
+#endif // COMMANDS_H
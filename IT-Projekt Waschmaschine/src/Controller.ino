@@ -13,6 +13,18 @@ Sections:
 - \link Controller.ino Controller \endlink
 - \link Commands Manual Commands \endlink
 - \link I2C_Master I2C_Master \endlink
+- \link TwiMaster TWI Master Driver \endlink
+- \link Scheduler Scheduler \endlink
+- \link Profiler Profiler \endlink
+- \link DoorSensor Door Sensor \endlink
+- \link CommandInput Command Input \endlink
+- \link Telemetry Binary Telemetry \endlink
+- \link FixedPoint Fixed Point Values \endlink
+- \link CommandTable Command Table \endlink
+- \link Polling Poll Scheduler \endlink
+- \link Setpoints Setpoint Shadow Registers \endlink
+- \link BinaryProtocol Binary Plant Protocol \endlink
+- \link WashPrograms Wash Programs \endlink
 
 Arduinos for Plant (top) and controller (below).
 
@@ -70,9 +82,32 @@ The washing machine running on an Arduino has following manual commands using th
 <tr><td> W? </td><td> warning </td></tr>
 <tr><td> V=x </td><td> verbose on/off </td></tr>
 <tr><td> R </td><td> (re)init </td></tr>
+<tr><td> T?C?A? </td><td> several values in one request, answered as "T=..;C=..;A=.." </td></tr>
+<tr><td> Z? </td><td> change status, one bit per value changed since read, in the order W T C A r L o w, answered as "Z=n" with bit 15 set, asked by the controller with every poll </td></tr>
+<tr><td> B? </td><td> binary protocol version, asked by the controller at start and after R, see \link BinaryProtocol Binary Plant Protocol \endlink </td></tr>
+<tr><td> S=n </td><td> start wash program n, 0 stops (controller only) </td></tr>
+<tr><td> S? </td><td> selected wash program and step, phase overlap and time heated or spun ahead (controller only) </td></tr>
+<tr><td> So=x </td><td> phase overlap of the wash programs on/off (controller only, see \link WashPrograms Wash Programs \endlink) </td></tr>
+<tr><td> s? </td><td> scheduler statistics, s=0 resets them (controller only) </td></tr>
+<tr><td> a? </td><td> refresh interval, age and polls per plant value and the setpoint shadow registers, a=0 resets the poll counts (controller only, see \link Polling Poll Scheduler \endlink) </td></tr>
+<tr><td> i? </td><td> I²C transactions, bus time per transaction, bytes, refused requests, round trip times, timeouts, retries, missing acknowledges, bus speed, bus recoveries and the plant protocol, i=0 resets them, i=100 or i=400 selects the bus speed in kHz (controller only) </td></tr>
+<tr><td> x? </td><td> I²C trace of the last transactions with time, duration, request and response (controller only, if compiled with I2C_TRACE) </td></tr>
+<tr><td> b=n </td><td> binary telemetry with n frames per second, 0 back to text (controller only, see \link Telemetry Binary Telemetry \endlink) </td></tr>
+<tr><td> b? </td><td> binary telemetry rate and skipped frames (controller only) </td></tr>
+<tr><td> c=x </td><td> record the I²C transactions as binary records on the USB port, for capture and replay by the host, see \link I2C_Master I2C Master \endlink (controller only) </td></tr>
+<tr><td> c? </td><td> recorded and dropped records (controller only) </td></tr>
+<tr><td> p? </td><td> execution time profile, p=0 resets it (controller only, see \link Profiler Profiler \endlink) </td></tr>
+<tr><td> f? </td><td> CPU cycles per value for atof() and ParseFixed() (controller only, with profiler) </td></tr>
 </table>
 with x either 1 or 0.
 
+Each command has to end with a line end ('\\n' or '\\r').
+The same commands are accepted line by line from the ESP over SoftwareSerial.
+Commands done by the controller itself are applied at once, in order,
+commands for the plant at one per I²C transaction.
+The setpoints D=x, r=n, O=n and o=n are written by the setpoint shadow registers
+and repeated until the plant acknowledges them, see \link Setpoints Setpoint Shadow Registers \endlink.
+
 All other commands will be transmitted to the simulated plant over I²C.
 <table border="0" width="80%">
 <tr><td> R   </td><td> (re)init </td></tr>
@@ -82,22 +117,33 @@ with x either 1 or 0.
 
 // include standard Arduino library
 #include "Arduino.h"
-// include standard I²C library
-#include "Wire.h"
 // include I²C connection
 #include "I2C_Master.h"
-// include Metro header for "Multitasking"
-#include "Metro.h"
+// include scheduler for "Multitasking"
+#include "Scheduler.h"
+// include execution time profiler
+#include "Profiler.h"
+// include door sensor
+#include "DoorSensor.h"
+// include command input
+#include "CommandInput.h"
+// include binary telemetry
+#include "Telemetry.h"
+// include fixed point values
+#include "FixedPoint.h"
+// include command table
+#include "Commands.h"
+// include I²C poll scheduler
+#include "Polling.h"
+// include setpoint shadow registers
+#include "Setpoints.h"
+// include binary plant protocol
+#include "BinaryProtocol.h"
 //include SoftwareSerial for additional serial communication
 #include "SoftwareSerial.h"
+// include wash program step tables
+#include "WashPrograms.h"
 
-                                                // time management
-//! for 10 msec detection
-unsigned long   msecPreviousMillis = 0;
-//! counter for 10 msec up to 100 msec
-int             nCount10msec = 0;
-//! counter for 100 msec up to 1sec
-int             nCount100msec = 0;
 // enable waschprogramm
 bool          isRunning = true;               
 
@@ -105,8 +151,44 @@ bool          isRunning = true;
                                                 // I2C
 //! Address for I²C slave
 const int       I2C_PLANT_ADDR = 10;
-//! standard 100KHz for I²C
-const long      I2C_FREQUENCY = 100000L;
+//! fast mode 400KHz for I²C, falls back to 100KHz on errors
+const long      I2C_FREQUENCY = I2C_FREQUENCY_FAST;
+//! tags of I²C requests, class in the upper bits, setpoint id in the lower bits
+enum RequestTag
+{
+  TAG_POLL      = 0x00,                         ///< poll of plant values
+  TAG_MANUAL    = 0x40,                         ///< typed command
+  TAG_SETPOINT  = 0x80,                         ///< setpoint write, | SetpointId
+  TAG_NOREPLY   = 0xC0,                         ///< result not used, e.g. reset
+  TAG_QUERY     = 0xC1,                         ///< protocol query BINARY_QUERY
+  TAG_CLASS     = 0xC0,                         ///< mask of the class bits
+  TAG_BINARY    = 0x20,                         ///< flag, request sent as binary frame
+  TAG_STATUS    = 0x10                          ///< flag, poll starts with the change status STATUS_KEY
+};
+//! binary protocol version of the plant, 0 for ASCII, see \link BinaryProtocol Binary Plant Protocol \endlink
+uint8_t         nPlantProtocol = 0;
+//! protocol query to be sent
+bool            bQueryProtocol = true;
+//! protocol query sent, not yet answered
+bool            bQueryOutstanding = false;
+//! start the I²C recorder with the next results taken, see StartRecorder()
+bool            bStartRecorder = false;
+//! binary requests answered in ASCII
+unsigned int    nBinaryFallbacks = 0;
+
+                                                // change status of the plant
+//! key of the change status word, "Z?" is answered with "Z=n"
+const char      STATUS_KEY = 'Z';
+//! bit set by every plant knowing the change status
+const uint16_t  STATUS_VALID = 0x8000;
+//! keys of the change status bits, bit 0 first, the warnings first
+const char      szStatusKeys[] = "WTCArLow";
+//! support of the change status by the plant
+enum ChangeStatusMode { CS_UNKNOWN, CS_ON, CS_OFF };
+//! change status support, see ChangeStatusMode
+uint8_t         nChangeStatus = CS_UNKNOWN;
+//! change status seen in the current response
+bool            bStatusSeen = false;
 
 //SoftwareSerial init
 SoftwareSerial esp_uno (10 , 11); // RX, TX
@@ -124,40 +206,101 @@ bool            bDoorClose = 0;                 ///< Türvariable
 
                                                 // static const PLC IO input numbers
 const int       nDoorClosed = 8;                ///< door closed sensor (Input)
+const int       nPlantAttention = 7;            ///< attention line of the plant, low active, optional
 
                                                 // live data from plant over I²C bus
-double          dTime = 0.0;                    ///< simulation time in min
-double          dTemperature = 0.0;             ///< temperature
-double          dWaterLevel = 0.0;              ///< water level
-double          dWasserInWaesche = 0.0;
+long            nTime = 0;                      ///< simulation time in 0.01 min
+int             nTemperature = 0;               ///< temperature in 0.01 °C
+int             nWaterLevel = 0;                ///< water level in g
+int             nWasserInWaesche = 0;           ///< water in laundry in g
 int             nWarnings = 0;                  ///< warning bits
 int             drpm = 0;                     ///< rpm
 int             dWaeschemenge = 0;            ///< Wäschemenge
 int             dWaschmittelmenge = 0;        ///< Waschmittelmange
 
+                                                // command table
+//! all commands for the plant and for digital IO, see \link CommandTable Command Table \endlink
+constexpr CommandDesc Commands[] PROGMEM =
+{
+  // key  direction  type         target               pin            refresh in 100 msec: idle fill heat wash drain
+  { 'T',  CMD_POLL,  VT_LFIXED2,  &nTime,              0,             { 10, 10, 10, 10, 10 } },                   // simulation time
+  { 'C',  CMD_POLL,  VT_FIXED2,   &nTemperature,       0,             { 5,  10, 1,  3,  10 } },                   // temperature
+  { 'A',  CMD_POLL,  VT_FIXED3,   &nWaterLevel,        0,             { 5,  1,  5,  5,  2 } },                    // water level
+  { 'W',  CMD_POLL,  VT_INT,      &nWarnings,          0,             { 5,  5,  5,  5,  5 } },                    // warnings
+  { 'r',  CMD_POLL,  VT_INT,      &drpm,               0,             { 10, 10, 10, 5,  2 } },                    // rpm
+  { 'L',  CMD_POLL,  VT_INT,      &dWaeschemenge,      0,             { POLL_ONCE, POLL_ONCE, POLL_ONCE, POLL_ONCE, POLL_ONCE } }, // Wäschemenge
+  { 'o',  CMD_POLL,  VT_INT,      &dWaschmittelmenge,  0,             { 20, 20, 20, 5,  20 } },                   // Waschmittel
+  { 'w',  CMD_POLL,  VT_FIXED3,   &nWasserInWaesche,   0,             { 20, 20, 20, 10, 5 } },                    // water in laundry
+  { 'I',  CMD_IO,    VT_BOOL,     nullptr,             nWaterIntake,  { } },                                      // water intake valve
+  { 'P',  CMD_IO,    VT_BOOL,     nullptr,             nWaterPump,    { } },                                      // water pump
+  { 'H',  CMD_IO,    VT_BOOL,     nullptr,             nHeating,      { } },                                      // heating
+};
+//! key character -> index in Commands, created at compile time
+const int8_t    CommandLookup[128] PROGMEM = { CMD_LOOKUP_TABLE(Commands) };
+//! offsets of the controller state in the state record of the I²C recorder, values little endian
+enum RecordedState
+{
+  RS_PROTOCOL,                                  ///< nPlantProtocol
+  RS_QUERY,                                     ///< protocol query to be sent or not yet answered
+  RS_CHANGE_STATUS,                             ///< nChangeStatus
+  RS_ACKED,                                     ///< setpoints acknowledged, one bit per SetpointId
+  RS_SETPOINTS,                                 ///< acknowledged values, 2 bytes per SetpointId
+  RS_VALID = RS_SETPOINTS + 2 * SP_COUNT,       ///< values received, one bit per entry of Commands, 2 bytes
+  RS_CHANGED = RS_VALID + 2,                    ///< values flagged as changed, 2 bytes
+  RS_AT_ONCE = RS_CHANGED + 2,                  ///< values to be polled next, 2 bytes
+  RS_VALUES = RS_AT_ONCE + 2,                   ///< per entry of Commands 4 bytes Command_Value() and 2 bytes age in msec
+  RS_COUNT = RS_VALUES + 6 * sizeof(Commands) / sizeof(Commands[0]) ///< number of bytes
+};
+
 //Variables for Communication between ESP and Uno
 char msgOut;
 //Serial buffer
 String Data = "";
 
 
-// Timing Variablen fürs "Multitasking" (Metro)
-Metro hundert = Metro(100);
-Metro fuenfhundert = Metro(500);
-Metro sekunde = Metro(1000);
-
-Metro temp100 = Metro(100);
-Metro akt_data = Metro(100);
-Metro send_data_plant = Metro(100);
-Metro send_data_esp = Metro(500);
-Metro receive_data_esp = Metro(500);
-Metro display_data = Metro(1000);
-Metro rpmtime = Metro(5000);
-Metro wp1_duration = Metro(60000);
-
-
-//! Banner and version number
-const char     szBanner[] = "# Washing Machine Controller V3.04";
+                                                // wash program
+//! selected wash program, 0 if none
+int             nWashProgram = 1;
+//! index of the current step in the program
+int             nWashStepIndex = 0;
+//! current step, copied from flash
+WashStepDef     CurrentStep = { WS_END, 0, 0 };
+//! true until the entry actions of the current step are done
+bool            bStepEnter = true;
+//! time the current step has been entered in msec
+unsigned long   msecStepStart = 0;
+//! temperature to hold in 0.01 °C, 0 if heating is off
+int             nTargetTemperature = 0;
+//! drum speed while tumbling, 0 if off
+int             nTumbleRpm = 0;
+//! drum on/off period while tumbling in msec
+unsigned long   msecTumblePeriod = 5000;
+//! time of the last drum on/off change in msec
+unsigned long   msecTumbleToggle = 0;
+//! drum currently commanded on
+bool            bRpmOn = false;
+//! overlap the phases of the wash program, see \link WashPrograms Wash Programs \endlink
+bool            bPhaseOverlap = true;
+//! steps of the program done ahead, one bit per step index
+uint32_t        nStepsAhead = 0;
+//! heating of the next WS_HEAT started while filling
+bool            bHeatAhead = false;
+//! time the heating started ahead in msec
+unsigned long   msecHeatAhead = 0;
+//! spin of the next WS_SPIN started while draining
+bool            bSpinAhead = false;
+//! time the spin started ahead in msec
+unsigned long   msecSpinAhead = 0;
+//! time heated or spun ahead by the phase overlap in msec
+unsigned long   msecOverlapAhead = 0;
+//! program paused by the open door
+bool            bDoorPaused = false;
+//! time the door has been opened in msec
+unsigned long   msecDoorOpened = 0;
+
+
+//! Banner and version number, in flash
+const char     szBanner[] PROGMEM = "# Washing Machine Controller V3.04";
 //! usual Arduino pin 13 LED
 const int       LEDpin = 13;
 
@@ -173,6 +316,25 @@ void ToggleDigitalIOPort(int nPin)
   digitalWrite(nPin, ! digitalRead(nPin));      // read, invert, write
 }
 
+                                                // task names, in flash
+const char      szTask10ms[] PROGMEM = "Task_10ms";
+const char      szTask100ms[] PROGMEM = "Task_100ms";
+const char      szTask1s[] PROGMEM = "Task_1s";
+
+//! static task table
+/*!
+All periodic functions with period and phase offset in msec and priority.
+The phase offsets keep the tasks from becoming due at the same time.
+The I²C task catches up missed activations to hold its 100 msec cycle on average.
+*/
+const SchedTask Tasks[] =
+{
+  //  task        name         period  phase  priority  overrun policy
+  { Task_10ms,  szTask10ms,  10,     0,     3,        SCHED_SKIP },
+  { Task_100ms, szTask100ms, 100,    3,     2,        SCHED_CATCH_UP },
+  { Task_1s,    szTask1s,    1000,   7,     1,        SCHED_SKIP },
+};
+
 //! usual arduino init function
 void setup()
 {
@@ -192,7 +354,7 @@ void setup()
   while ( ! Serial )                            // wait for serial port, ATmega32U4 chips only
     ;
 #endif
-  Serial.println(szBanner);                     // show banner and version
+  Serial.println((const __FlashStringHelper *)szBanner); // show banner and version
 
   pinMode(10, INPUT);
   pinMode(11, OUTPUT);
@@ -204,11 +366,14 @@ void setup()
 
   // initialize IO, PLC inputs
   pinMode(nDoorClosed, INPUT);                  // door closed sensor
-  pinMode(doorSwitch, INPUT_PULLUP);            // door mechanism
-
-  msecPreviousMillis = millis();                // init global timing
+  pinMode(nPlantAttention, INPUT_PULLUP);       // attention line, stays high if not wired
+  Door_Setup(doorSwitch, DoorInterlock);        // door mechanism, interrupt driven
 
   I2C_Master_Setup(I2C_FREQUENCY);              // start I²C master
+
+  Scheduler_Setup(Tasks);                       // init global timing
+  Poll_Setup(Commands);                         // init I²C poll scheduler
+  Setpoint_Invalidate();                        // plant setpoints unknown, write them once
 }
 
 //! reset initial IO positions
@@ -222,7 +387,9 @@ void ResetIO()
 
 //! Check if a command has been typed
 /*!
-Check if a command has been typed over COM-Port.
+Check if a command has been typed over COM-Port or received from the ESP.
+
+Takes the oldest complete command line from the command queue, see \link CommandInput Command Input \endlink.
 
 \param szCommand storage for a typed command
 \param nCommandLengthMax size of szCommand
@@ -230,23 +397,31 @@ Check if a command has been typed over COM-Port.
 */
 bool CheckIfTypedAvailable(char szCommand[], int nCommandLengthMax)
 {
-  *szCommand = 0;                               // initially empty result
-  if ( Serial.available() > 0 )
-  {                                             // work on manual command
-    int   ch;
-    int   nCommandLen = 0;
-    while ( ( ch = Serial.read() ) > 0 )
-    {
-      if ( nCommandLen < nCommandLengthMax )
-      {
-        szCommand[nCommandLen++] = ch;          // collect characters
-        szCommand[nCommandLen] = 0;             // append a trailing zero byte
-      }
-    }
-    return true;                                // command complete
+  return Command_Take(szCommand, nCommandLengthMax);
+}
+
+//! Program phase for the poll scheduler
+/*!
+Program phase for the poll scheduler, taken from the current wash program step.
+
+\returns see PollPhase
+*/
+uint8_t CurrentPollPhase()
+{
+  if ( ( isRunning == false ) || ( nWashProgram == 0 ) )
+    return PH_IDLE;
+  switch ( CurrentStep.nOp )
+  {
+  case WS_FILL:
+    return PH_FILL;
+  case WS_HEAT:
+    return PH_HEAT;
+  case WS_DRAIN:
+  case WS_SPIN:
+    return PH_DRAIN;
+  default:
+    return PH_WASH;
   }
-  else
-    return false;
 }
 
 //! Create next steady transmitted command
@@ -255,55 +430,164 @@ Create next of steadily transmitted requests or commands to the plant.
 
 Assume the buffer is large enough for all automatically created commands.
 
-The state machine here may be expanded to support more commands.
 Commands are created to cyclically transmit and/or request values to or from the plant.
+They are taken from the command table Commands by the poll scheduler,
+the most overdue value for the current program phase first, see \link Polling Poll Scheduler \endlink.
+Further due values are batched into the same request, e.g. "T?C?A?".
+To poll or send more values just add them to the table.
 
-Please note the state value nIndex has to be static to remain in existence after leaving the function.
-The index is incremented in every call and reset to zero after all commands have been generated once.
+Unless the plant is known not to support it, every poll starts with the change status "Z?",
+then only changed values are polled, see TakeChangeStatus().
 
 \param szCommand storage for a typed command
 \returns true if a command has been created
 */
 bool CreateNextSteadyCommand(char szCommand[])
 {
-  *szCommand = 0;                               // initially empty
+  Poll_SetPhase(CurrentPollPhase());
+  int   nPrefix = 0;
+  int   nResponseMax = I2C_ResponseMax(I2C_PLANT_ADDR);
+  if ( nChangeStatus != CS_OFF )
+  {                                             // change status first, "Z=32768;"
+    szCommand[nPrefix++] = STATUS_KEY;
+    szCommand[nPrefix++] = '?';
+    nResponseMax -= 2 + 5 + 1;
+  }
+  return ( Poll_Next(szCommand + nPrefix, nResponseMax) > 0 ) || ( nPrefix > 0 ); // true if command buffer not empty
+}
+
+//! Take the change status of the plant
+/*!
+Take the change status word of the plant.
 
-  static int   nIndex = 0;                      // index walking through requests
-  switch ( ++nIndex )
+A plant knowing the change status answers "Z?" with STATUS_VALID and one bit per value changed since it has been read,
+in the order of szStatusKeys, the warnings in bit 0.
+It clears a bit as soon as the value has been read.
+Changed values are flagged for the poll scheduler, the warnings to be polled at once.
+Without STATUS_VALID the plant does not know the change status and the values are polled by their freshness.
+
+\param nStatus change status word
+*/
+void TakeChangeStatus(uint16_t nStatus)
+{
+  bStatusSeen = true;
+  if ( ! ( nStatus & STATUS_VALID ) )
+  {                                             // old plant
+    nChangeStatus = CS_OFF;
+    Poll_SetChangeDriven(false);
+    return;
+  }
+  if ( nChangeStatus != CS_ON )
   {
-  case 1:                                       // request time
-    strcpy(szCommand, "T?");                    // build command
-    break;
-  case 2:                                       // request temperature
-    strcpy(szCommand, "C?");                    // build command
-    break;
-  case 3:                                       // request water level
-    strcpy(szCommand, "A?");                    // build command
-    break;
-  case 4:                                       // request warnings
-    strcpy(szCommand, "W?");                    // build command
-    break;
-  case 5:                                       // request door state
-    if(bDoorClose == true)
-      strcpy(szCommand, "D=1");                 // Tür zu
-    else
-      strcpy(szCommand, "D=0");                 // Tür auf
-    break;
-  case 6:
-      strcpy(szCommand, "r?");                  // rpm Abfrage
-  case 7:
-    strcpy(szCommand, "L?");                    // Wäschemenge Abfrage
-    break;
-  case 8:
-    strcpy(szCommand, "o?");                    // Waschmittel Abfrage
-    break;
+    nChangeStatus = CS_ON;
+    Poll_SetChangeDriven(true);
+  }
+  for ( uint8_t i = 0; szStatusKeys[i] != 0; ++i )
+    if ( nStatus & ( 1U << i ) )
+      Poll_Changed(Command_Find(CommandLookup, szStatusKeys[i]), i == 0);
+}
 
-  // more cases for other requests or settings
-  default:
-    nIndex = 0;                                 // start over
-    break;
+//! Get the state for a recording
+/*!
+Get what the controller has learned from the plant so far, see RecordedState:
+the protocol, the change status support, the acknowledged setpoints, the values received with their ages
+and the changes reported but not yet polled.
+The I²C recorder writes it when it starts, see StartRecorder().
+
+\param State storage for RS_COUNT bytes
+*/
+void GetRecordedState(uint8_t State[])
+{
+  memset(State, 0, RS_COUNT);
+  State[RS_PROTOCOL] = nPlantProtocol;
+  State[RS_QUERY] = bQueryProtocol || bQueryOutstanding;
+  State[RS_CHANGE_STATUS] = nChangeStatus;
+  for ( uint8_t i = 0; i < SP_COUNT; ++i )
+  {
+    int   nAcked = Setpoint_Acked(i);
+    if ( Setpoint_IsAcked(i) )
+      State[RS_ACKED] |= 1 << i;
+    State[RS_SETPOINTS + 2*i] = nAcked & 0xFF;
+    State[RS_SETPOINTS + 2*i + 1] = ( nAcked >> 8 ) & 0xFF;
+  }
+  CommandDesc   desc;
+  for ( int i = 0; i < (int)( sizeof(Commands) / sizeof(Commands[0]) ); ++i )
+  {
+    Command_Get(Commands, i, desc);
+    if ( desc.nDirection != CMD_POLL )
+      continue;
+    bool  bAtOnce;
+    if ( Poll_IsChanged(i, &bAtOnce) )
+      State[RS_CHANGED + i / 8] |= 1 << ( i % 8 );
+    if ( bAtOnce )
+      State[RS_AT_ONCE + i / 8] |= 1 << ( i % 8 );
+    unsigned long msecAge = Poll_Age(i);
+    if ( msecAge >= POLL_AGE_MAX )
+      continue;                                 // never received
+    long  nValue = Command_Value(desc);
+    State[RS_VALID + i / 8] |= 1 << ( i % 8 );
+    for ( int n = 0; n < 4; ++n )
+      State[RS_VALUES + 6*i + n] = ( nValue >> ( 8 * n ) ) & 0xFF;
+    State[RS_VALUES + 6*i + 4] = msecAge & 0xFF;
+    State[RS_VALUES + 6*i + 5] = ( msecAge >> 8 ) & 0xFF;
+  }
+}
+
+//! Start the I²C recorder
+/*!
+Start recording with the state record, once Task_100ms() has taken all results of the plant and before it queues the next poll.
+So the state holds every result done before, none is left out of the log,
+and a replay taking the state before the same task asks the plant the same from there on.
+*/
+void StartRecorder()
+{
+  uint8_t       State[RS_COUNT];
+  GetRecordedState(State);
+  I2C_SetRecorder(&Serial, State, sizeof(State));
+  bStartRecorder = false;
+}
+
+//! Take the state of a recording
+/*!
+Take the state GetRecordedState() has written into the log when the recording started.
+A replay takes it just before the task which wrote it,
+so from there on the controller asks the plant the same as in the field.
+
+\param pState state bytes
+\param nLength number of bytes
+\param msecEarly msec the state is taken before the time of the record, the ages are that much shorter
+*/
+void TakeRecordedState(const uint8_t * pState, int nLength, unsigned long msecEarly)
+{
+  if ( nLength < RS_COUNT )
+    return;                                     // no state, the replay learns it as in the field
+  if ( ! pState[RS_QUERY] )
+  {                                             // answered, a query under way the replay sends itself
+    nPlantProtocol = pState[RS_PROTOCOL];
+    bQueryProtocol = false;
+  }
+  nChangeStatus = pState[RS_CHANGE_STATUS];
+  Poll_SetChangeDriven(nChangeStatus == CS_ON);
+  for ( uint8_t i = 0; i < SP_COUNT; ++i )
+    if ( pState[RS_ACKED] & ( 1 << i ) )
+      Setpoint_Preset(i, (int16_t)( pState[RS_SETPOINTS + 2*i] | ( pState[RS_SETPOINTS + 2*i + 1] << 8 ) ));
+  CommandDesc   desc;
+  for ( int i = 0; i < (int)( sizeof(Commands) / sizeof(Commands[0]) ); ++i )
+  {
+    uint8_t nBit = 1 << ( i % 8 );
+    if ( pState[RS_VALID + i / 8] & nBit )
+    {
+      uint32_t  nValue = 0;
+      for ( int n = 3; n >= 0; --n )
+        nValue = ( nValue << 8 ) | pState[RS_VALUES + 6*i + n];
+      Command_Get(Commands, i, desc);
+      Command_StoreValue(desc, (int32_t)nValue);
+      unsigned long msecAge = pState[RS_VALUES + 6*i + 4] | ( pState[RS_VALUES + 6*i + 5] << 8 );
+      Poll_Preset(i, ( msecAge > msecEarly ) ? msecAge - msecEarly : 0);
+    }
+    if ( pState[RS_CHANGED + i / 8] & nBit )
+      Poll_Changed(i, ( pState[RS_AT_ONCE + i / 8] & nBit ) != 0);
   }
-  return ( *szCommand != 0 );                   // return true if command buffer not empty
 }
 
 //! Handle all commands which use digital IO
@@ -311,11 +595,17 @@ bool CreateNextSteadyCommand(char szCommand[])
 Handle all commands which use digital IO.
 
 Several commands are not transmitted over I²C but set or reset digital outputs.
+They are the CMD_IO entries of the command table.
 
-\param szCommand storage for a typed command
+Water intake and heating are interlocked with the door: while it is open "I=1" and "H=1" are refused,
+typed or from the wash program.
+Test and write are done with interrupts off, so the door interrupt either comes before and the output stays off,
+or after and DoorInterlock() switches it off again.
+
+\param szCommand typed command, e.g. "H=1"
 \returns true if command has been done
 */
-bool WorkOnCommandsForDigitalIO(char szCommand[])
+bool WorkOnCommandsForDigitalIO(const char * szCommand)
 {
   if ( szCommand[1] == '=' )                    // test all assignments
   {
@@ -326,23 +616,22 @@ bool WorkOnCommandsForDigitalIO(char szCommand[])
             || ( szCommand[3] == '\n' ) ) )
     {
       bool  bValue = ( szCommand[2] == '1' );
-      switch ( szCommand[0] )
+      int   nIndex = Command_Find(CommandLookup, szCommand[0]);
+      if ( nIndex >= 0 )
       {
-      case 'I':
-        digitalWrite(nWaterIntake, bValue);
-        return true;                            // done
-      case 'P':
-        digitalWrite(nWaterPump, bValue);
-        return true;                            // done
-      case 'H':
-        digitalWrite(nHeating, bValue);
-        return true;                            // done
-      //case'D':
-         //digitalWrite(nDoorOpen, bValue);
-         //return true;
-      default:
-        break;                                  // expect an I²C a command, see below
+        CommandDesc desc;
+        Command_Get(Commands, nIndex, desc);
+        if ( desc.nDirection == CMD_IO )
+        {
+          bool  bInterlocked = bValue && ( ( desc.nPin == nWaterIntake ) || ( desc.nPin == nHeating ) );
+          noInterrupts();
+          if ( ! bInterlocked || Door_IsClosed() )
+            digitalWrite(desc.nPin, bValue);
+          interrupts();
+          return true;                          // done, refused while the door is open
+        }
       }
+      // else expect an I²C a command, see below
     }
   }
   // else if ( szCommand[1] == '?' )            // value requests not yet implemented, not required so far
@@ -354,219 +643,740 @@ bool WorkOnCommandsForDigitalIO(char szCommand[])
 /*!
 Interpret an I²C response from the plant.
 
-If more command types have been issued in function CreateNextSteadyCommand() the responses from the plant will return here.
+The responses to all commands from function CreateNextSteadyCommand() return here.
+A response holds one or, for a batched request, several values "k=value" separated by ';', ',' or blanks.
+Each key is looked up in the command table and the value is stored in the target variable of its entry.
+The poll scheduler gets the age stamp of the value.
 
 \param szResponse storage for a typed command
-\returns true if response has been used
+\returns true if at least one value has been used
 */
 bool InterpreteResponse(char szResponse[])
 {
-  if ( szResponse[1] == '=' )
-  {                                             // seems to be a valid response
-    switch ( szResponse[0] )
+  bool          bUsed = false;
+  const char *  p = szResponse;
+  while ( *p != 0 )
+  {
+    if ( Command_IsSeparator(*p) )
     {
-    case 'T':                                   // got a fresh dTime value
-      dTime = atof(szResponse+2);               // convert response part after '=' to double
-      return true;                              // done
-    case 'C':                                   // got a fresh dTemperature value
-      dTemperature = atof(szResponse+2);        // convert response part after '=' to double
-      return true;                              // done
-    case 'A':                                   // got a fresh dWaterLevel value
-      dWaterLevel = atof(szResponse+2);         // convert response part after '=' to double
-      return true;                              // done
-    case 'W':                                   // got a fresh warning bits value
-      nWarnings = atoi(szResponse+2);           // convert response part after '=' to integer
-      return true;                              // done
-    ///*!
-    case 'D':
-      bDoorClose = atoi(szResponse+2);
-      return true;
-    //*/
-    case 'r':
-      drpm = atoi(szResponse+2);              // convert response part after '=' to integer
-      return true;
-    case 'L':
-      dWaeschemenge = atof(szResponse+2);
-      return true;
-    case 'o':
-      dWaschmittelmenge = atof(szResponse+2);
-      return true;
-    // more cases may follow
+      ++p;                                      // skip separators
+      continue;
+    }
+    if ( ( p[0] == STATUS_KEY ) && ( p[1] == '=' ) )
+    {
+      TakeChangeStatus(atol(p+2));
+      bUsed = true;
+    }
+    else if ( p[1] == '=' )
+    {
+      int   nIndex = Command_Find(CommandLookup, p[0]);
+      if ( nIndex >= 0 )
+      {
+        CommandDesc desc;
+        Command_Get(Commands, nIndex, desc);
+        if ( desc.pTarget != nullptr )          // not for digital IO
+        {
+          Command_Store(desc, p+2);             // convert value after '=' to the target type
+          Poll_Received(nIndex);                // age stamp
+          bUsed = true;
+        }
+      }
     }
+    while ( ( *p != 0 ) && ! Command_IsSeparator(*p) )
+      ++p;                                      // next value
   }
-  return false;                                 // response not handled
+  return bUsed;                                 // done
 }
 
-//Sets Door status based on closed circuit on Pin 
+//! Interpret a binary I²C response from the plant
+/*!
+Interpret a binary response from the plant, see \link BinaryProtocol Binary Plant Protocol \endlink.
 
-void door()
+Same as InterpreteResponse(), but the values come as scaled integers and are stored without parsing.
+
+\param pResponse response frame
+\param nLength frame length
+\returns true if at least one value has been used
+*/
+bool InterpreteBinary(const uint8_t * pResponse, int nLength)
 {
-  if(digitalRead(doorSwitch) == false)
-  {
-    //Serial.print("funktionirt bis hier hin!");
-    digitalWrite(nDoorClosed, true);             // Door
-  } 
-  else
+  bool          bUsed = false;
+  char          cId;
+  long          nValue;
+  int           nPos = 1;                       // behind the frame start
+  while ( ( nPos = Binary_Next(pResponse, nLength, nPos, &cId, &nValue) ) > 0 )
   {
-    //Serial.print("Läuft nícht!");
-    //WorkOnCommandsForDigitalIO(D=0)  
-    //Serial.println("Ist offen");
-    digitalWrite(nDoorClosed, false);             // Door
+    if ( cId == STATUS_KEY )
+    {
+      TakeChangeStatus(nValue);
+      bUsed = true;
+      continue;
+    }
+    int   nIndex = Command_Find(CommandLookup, cId);
+    if ( nIndex < 0 )
+      continue;
+    CommandDesc desc;
+    Command_Get(Commands, nIndex, desc);
+    if ( desc.pTarget != nullptr )              // not for digital IO
+    {
+      Command_StoreValue(desc, nValue);
+      Poll_Received(nIndex);                    // age stamp
+      bUsed = true;
     }
+  }
+  return bUsed;
 }
 
-void charArrOut(char arr[])
+//! Door interlock
+/*!
+Door interlock, called from the door sensor interrupt as soon as the door opens.
+
+Drops water intake and heating at once, the drum is stopped by door().
+*/
+void DoorInterlock()
 {
+  digitalWrite(nWaterIntake, false);            // water intake valve
+  digitalWrite(nHeating, false);                // heater
+}
 
+//! Sets door status from the debounced door sensor
+/*!
+Sets door status from the debounced door sensor, see \link DoorSensor Door Sensor \endlink.
+
+A state change is sent to the plant with priority by Task_100ms(), see \link Setpoints Setpoint Shadow Registers \endlink.
+When the door opens the drum is stopped, right after the door state.
+*/
+void door()
+{
+  bool  bClosed;
+  bool  bChanged = Door_TakeChange(&bClosed);
+  digitalWrite(nDoorClosed, bClosed);           // Door
+  if ( ! bChanged )
+    return;
+  bDoorClose = bClosed;
+  Setpoint_Set(SP_DOOR, bClosed);
+  if ( ! bClosed )
+  {
+    Setpoint_Set(SP_DRUM, 0);                   // stop drum
+    bRpmOn = false;
+  }
 }
 
-int handleTemp(double tTemperature)
+void charArrOut(char arr[])
 {
 
-  bool i = true;                                  // Wenn true -> while-Schleife läuft
+}
+
+//! Regulate water temperature
+/*!
+Regulate water temperature, one step per call.
 
-  while(i == true) 
+Switches the heating on below the target and off inside the target band or above.
+The heating stays off while the door is open, see WorkOnCommandsForDigitalIO().
+Never waits, it is called again and again by the wash program.
+
+\param tTemperature target temperature in 0.01 °C
+\returns true if temperature is inside the target band
+*/
+bool handleTemp(int tTemperature)
+{
+  if ( nTemperature < tTemperature )
   {
+    WorkOnCommandsForDigitalIO("H=1");          // Heizung an
+    return false;
+  }
+  WorkOnCommandsForDigitalIO("H=0");            // Heizung aus
+  return ( nTemperature < tTemperature + 200 ); // Temperatur ist im Rahmen
+}
+
+//! Fill in water
+/*!
+Fill in water, one step per call.
 
-  if(dTemperature < tTemperature)
+Opens the water intake valve while the water level is below the target.
+The valve stays closed as long as the door is open.
+
+\param tWaterlevel target water level in g
+\returns true if the water level has been reached
+*/
+bool handleWater(int tWaterlevel)
+{
+  if ( Door_IsClosed() && ( tWaterlevel > nWaterLevel ) )
   {
-      WorkOnCommandsForDigitalIO("H=1");
-      Task_100ms();
-      I2C_Master_Steady();                          // give background processing a chance
-      Serial.println("Heizung An");
-      Serial.println(" C=");
-      Serial.print(dTemperature);
+    WorkOnCommandsForDigitalIO("I=1");          // Ventil auf
+    return false;
   }
+  WorkOnCommandsForDigitalIO("I=0");            // Ventil zu
+  return ( tWaterlevel <= nWaterLevel );
+}
 
-  else if(dTemperature >= tTemperature && dTemperature < tTemperature + 2)
+//! Start or stop a wash program
+/*!
+Start or stop a wash program.
+
+A running program is stopped and all actuators are switched off first.
+
+\param nProgram program number 1..WASH_PROGRAM_COUNT, 0 just stops
+\returns true on success, false for an unknown program number
+*/
+bool StartWashProgram(int nProgram)
+{
+  if ( ( nProgram < 0 ) || ( nProgram > WASH_PROGRAM_COUNT ) )
+    return false;
+  WorkOnCommandsForDigitalIO("I=0");
+  WorkOnCommandsForDigitalIO("H=0");
+  WorkOnCommandsForDigitalIO("P=0");
+  Setpoint_Set(SP_DRUM, 0);                     // written only if the drum turns
+  bRpmOn = false;
+  nTumbleRpm = 0;
+  nTargetTemperature = 0;
+  nWashStepIndex = 0;
+  bStepEnter = true;
+  bDoorPaused = false;
+  nStepsAhead = 0;
+  bHeatAhead = false;
+  bSpinAhead = false;
+  nWashProgram = nProgram;
+  isRunning = ( nProgram != 0 );
+  if ( isRunning )
   {
-    WorkOnCommandsForDigitalIO("H=0");
-    Task_100ms();
-    I2C_Master_Steady();                          // give background processing a chance
-    Serial.println("Temperatur ist im Rahmen");
-    Serial.print(" C=");
-    Serial.print(dTemperature);
-    i = false;
+    msecOverlapAhead = 0;
+    Poll_Restart();                             // fresh values, POLL_ONCE values again
   }
+  return true;
+}
+
+//! Read a step of the wash program from flash
+/*!
+Read a step of the selected wash program from flash.
+
+\param nIndex step index, at most the index of WS_END
+\param pStep storage for the step
+*/
+void ReadWashStep(int nIndex, WashStepDef * pStep)
+{
+  const WashStepDef * pProgram = (const WashStepDef *)pgm_read_ptr(&WashPrograms[nWashProgram-1]);
+  memcpy_P(pStep, &pProgram[nIndex], sizeof(*pStep));
+}
+
+//! Load the current step of the wash program from flash
+void LoadWashStep()
+{
+  ReadWashStep(nWashStepIndex, &CurrentStep);
+}
 
-  else 
+//! Overlap the fill
+/*!
+Start the steps ahead which do not need more water than the level WASH_LEVEL_OVERLAP reached while filling:
+the heating of the next WS_HEAT and the next WS_DOSE steps, up to the next step changing the water.
+Dosed steps are marked in nStepsAhead and skipped later, the WS_HEAT step still waits for its temperature.
+*/
+void OverlapFill()
+{
+  WashStepDef   step;
+  for ( int nIndex = nWashStepIndex + 1; nIndex < WASH_STEPS_AHEAD_MAX; ++nIndex )
   {
+    ReadWashStep(nIndex, &step);
+    if ( ( step.nOp == WS_END ) || ( step.nOp == WS_FILL ) || ( step.nOp == WS_DRAIN ) || ( step.nOp == WS_SPIN ) )
+      return;                                   // water changes
+    if ( ( step.nOp == WS_DOSE ) && ! ( nStepsAhead & ( 1UL << nIndex ) ) )
+    {
+      Setpoint_Set( ( step.nArg == 'O' ) ? SP_DETERGENT : SP_SOFTENER, step.nValue, true );
+      nStepsAhead |= 1UL << nIndex;
+    }
+    else if ( ( step.nOp == WS_HEAT ) && ! bHeatAhead && ( nTargetTemperature < step.nValue * 100 ) )
+    {
+      nTargetTemperature = step.nValue * 100;   // held by RunWashProgram()
+      bHeatAhead = true;
+      msecHeatAhead = millis();
+    }
+  }
+}
+
+//! Overlap the drain
+/*!
+Start the spin of the next step while draining, if it is a WS_SPIN.
+*/
+void OverlapDrain()
+{
+  WashStepDef   step;
+  ReadWashStep(nWashStepIndex + 1, &step);
+  if ( step.nOp != WS_SPIN )
+    return;
+  Setpoint_Set(SP_DRUM, step.nValue);
+  bSpinAhead = true;
+  msecSpinAhead = millis();
+}
+
+//! Execute the current wash program step
+/*!
+Execute the current wash program step once.
+
+Called every 100 msec, never waits.
+Commands for the plant are set as setpoints, see \link Setpoints Setpoint Shadow Registers \endlink.
+
+\returns true if the step is complete
+*/
+bool ExecuteWashStep()
+{
+  unsigned long msecInStep = millis() - msecStepStart;
+
+  if ( bStepEnter )
+  {                                             // entry actions
+    switch ( CurrentStep.nOp )
+    {
+    case WS_DOSE:
+      Setpoint_Set( ( CurrentStep.nArg == 'O' ) ? SP_DETERGENT : SP_SOFTENER, CurrentStep.nValue, true );
+      return true;                              // nothing to wait for
+    case WS_HEAT:
+      nTargetTemperature = CurrentStep.nValue * 100;
+      break;
+    case WS_TUMBLE:
+      nTumbleRpm = CurrentStep.nValue;
+      msecTumblePeriod = CurrentStep.nArg * 1000UL;
+      msecTumbleToggle = millis() - msecTumblePeriod; // first change right now
+      return true;                              // runs in background
+    case WS_DRAIN:
+    case WS_SPIN:
+      Setpoint_Set(SP_DRUM, ( CurrentStep.nOp == WS_SPIN ) ? CurrentStep.nValue : 0);
       WorkOnCommandsForDigitalIO("H=0");
-      Task_100ms();
-      I2C_Master_Steady();                          // give background processing a chance
-      Serial.println("Heizung aus");
-      Serial.println(" C=");
-      Serial.print(dTemperature);
+      WorkOnCommandsForDigitalIO("P=1");        // abpumpen
+      nTargetTemperature = 0;
+      nTumbleRpm = 0;
+      bRpmOn = false;
+      break;
+    default:
+      break;
+    }
+    bStepEnter = false;
+    msecStepStart = millis();
+    msecInStep = 0;
+    if ( bSpinAhead && ( CurrentStep.nOp == WS_SPIN ) )
+    {                                           // spinning since the drain
+      msecInStep = millis() - msecSpinAhead;
+      msecStepStart = msecSpinAhead;
+      msecOverlapAhead += msecInStep;
+      bSpinAhead = false;
+    }
   }
-      Serial.println("Temp Schleife läuft noch!!!");
+
+  switch ( CurrentStep.nOp )
+  {
+  case WS_FILL:                                 // Wassermenge einstellen
+    if ( bPhaseOverlap && ( nWaterLevel >= WASH_LEVEL_OVERLAP ) )
+      OverlapFill();
+    if ( ! handleWater(CurrentStep.nValue * 100) )
+      return false;
+    if ( bHeatAhead )
+    {                                           // heated while filling
+      msecOverlapAhead += millis() - msecHeatAhead;
+      bHeatAhead = false;
+    }
+    return true;
+  case WS_HEAT:                                 // Wassertemperatur einstellen
+    return ( nTemperature >= nTargetTemperature );
+  case WS_HOLD:
+    return ( msecInStep >= CurrentStep.nValue * 1000UL );
+  case WS_DRAIN:
+    if ( bPhaseOverlap && ! bSpinAhead && ( nWaterLevel < WASH_LEVEL_SPIN ) )
+      OverlapDrain();
+    if (   ( nWaterLevel > 0 )
+        && ( msecInStep < CurrentStep.nValue * 1000UL ) )
+      return false;
+    if ( ! bSpinAhead )
+      WorkOnCommandsForDigitalIO("P=0");        // the spin pumps on
+    return true;
+  case WS_SPIN:
+    if ( msecInStep < CurrentStep.nArg * 1000UL )
+      return false;
+    Setpoint_Set(SP_DRUM, 0);
+    WorkOnCommandsForDigitalIO("P=0");
+    return true;
+  default:
+    return true;
   }
-  return 0;
 }
 
-int handleWater(double tWaterlevel)
+//! Pause the wash program
+/*!
+Pause the wash program as the door has been opened.
+
+The drum has been stopped by door() already, the pump is switched off here.
+The time of the pause is taken out of the step by ResumeWashProgram().
+*/
+void PauseWashProgram()
+{
+  WorkOnCommandsForDigitalIO("P=0");            // no pumping with the door open
+  bDoorPaused = true;
+  msecDoorOpened = millis();
+}
+
+//! Resume the wash program
+/*!
+Resume the wash program paused by PauseWashProgram() as the door has been closed again.
+
+The timers of the step go on where they stopped, so WS_HOLD, WS_DRAIN and WS_SPIN get their full time.
+Drum and pump of a WS_DRAIN or WS_SPIN are switched on again, tumbling restarts at once.
+*/
+void ResumeWashProgram()
 {
-  if(digitalRead(nDoorClosed) == true)
+  unsigned long msecPaused = millis() - msecDoorOpened;
+  bDoorPaused = false;
+  msecStepStart += msecPaused;
+  msecSpinAhead += msecPaused;
+  msecHeatAhead += msecPaused;
+  if ( nTumbleRpm != 0 )
+    msecTumbleToggle = millis() - msecTumblePeriod; // first change right now
+  if ( bStepEnter )
+    return;                                     // entry actions still to come
+  if ( CurrentStep.nOp == WS_SPIN )
+    Setpoint_Set(SP_DRUM, CurrentStep.nValue);
+  else if ( ( CurrentStep.nOp == WS_DRAIN ) && bSpinAhead )
   {
-    while(tWaterlevel > dWaterLevel) 
-    {
-      WorkOnCommandsForDigitalIO("I=1");
-      Task_100ms();
-      I2C_Master_Steady();                          // give background processing a chance
-      Serial.println("Ventil Auf");
-      Serial.println(" A=");
-      Serial.print(dWaterLevel);
-    }
+    WashStepDef step;
+    ReadWashStep(nWashStepIndex + 1, &step);
+    Setpoint_Set(SP_DRUM, step.nValue);         // spun ahead, see OverlapDrain()
+  }
+  if ( ( CurrentStep.nOp == WS_DRAIN ) || ( CurrentStep.nOp == WS_SPIN ) )
+    WorkOnCommandsForDigitalIO("P=1");          // abpumpen
+}
+
+//! Run the selected wash program
+/*!
+Run the selected wash program as an interpreter of its step table.
+
+Called every 100 msec from Task_100ms().
+Each call does one step of work and returns immediately, no waiting loops at all.
+Heating to the last WS_HEAT temperature and tumbling go on in the background.
+The program pauses while the door is open and continues after the door is closed again,
+see PauseWashProgram() and ResumeWashProgram().
+Steps done ahead by the phase overlap are skipped without a pass of their own.
+*/
+void RunWashProgram()
+{
+  if ( ( isRunning == false ) || ( nWashProgram == 0 ) )
+    return;                                     // nothing to do
+
+  if ( ! Door_IsClosed() )
+  {                                             // door open, keep everything off
+    if ( ! bDoorPaused )
+      PauseWashProgram();
     WorkOnCommandsForDigitalIO("I=0");
-    Task_100ms();
-    I2C_Master_Steady();                          // give background processing a chance
-    Serial.println("Ventil Zu");
+    WorkOnCommandsForDigitalIO("H=0");
+    return;
+  }
+  if ( bDoorPaused )
+    ResumeWashProgram();
+
+  if ( nTargetTemperature > 0 )
+    handleTemp(nTargetTemperature);             // Temperatur halten
+
+  if (   ( nTumbleRpm != 0 )
+      && ( ( millis() - msecTumbleToggle ) >= msecTumblePeriod ) )
+  {                                             // Trommel an/aus
+    bRpmOn = ! bRpmOn;
+    Setpoint_Set(SP_DRUM, bRpmOn ? nTumbleRpm : 0);
+    msecTumbleToggle += msecTumblePeriod;
+    if ( ( millis() - msecTumbleToggle ) >= msecTumblePeriod )
+      msecTumbleToggle = millis();              // was held back, restart period
+  }
+
+  if ( bStepEnter && ( nWashStepIndex == 0 ) )
+    LoadWashStep();                             // first step of the program
+  if ( ! ExecuteWashStep() )
+    return;
+
+  for ( ;; )
+  {
+    ++nWashStepIndex;                           // step done, next one
+    bStepEnter = true;
+    LoadWashStep();
+    Serial.print(F("# WP"));
+    Serial.print(nWashProgram);
+    Serial.print(F(" step "));
+    Serial.println(nWashStepIndex);
+    if ( ( nWashStepIndex >= WASH_STEPS_AHEAD_MAX ) || ! ( nStepsAhead & ( 1UL << nWashStepIndex ) ) )
+      break;
+  }
+  if ( CurrentStep.nOp == WS_END )
+  {
+    Serial.print(F("# WP"));
+    Serial.print(nWashProgram);
+    Serial.print(F(" ahead "));
+    PrintOverlapAhead();
+    Serial.println(F(" s"));
+    StartWashProgram(0);                        // switch everything off
+    Serial.println(F("# WP done"));
   }
 }
 
-void waschprogramm1()
+//! Print the time heated or spun ahead
+void PrintOverlapAhead()
 {
-  int     O = 3;                    // Maschpulvermenge
-  int     o = 2;                    // Weichspüler
-  int     rpm = 800;                // Trommel rpm
-  double  targetTemperature = 60;   // Ziel Wassertemperatur
-  double  targetWaterLevel = 1.3;   // Ziel Wassermenge
-  bool    isFilled = false;         // Wenn Wassermenge erreicht -> true
-  bool    rpmONOFF = false;         // Schaltet Trommeldrehzahl an oder aus
+  Serial.print(msecOverlapAhead / 1000);
+  Serial.print('.');
+  Serial.print(( msecOverlapAhead / 100 ) % 10);
+}
 
-  
+//! Handle wash program commands
+/*!
+Handle wash program commands "S=n", "S?" and "So=x".
 
-  //strcpy(szCommand, "I=1");
-  while(isRunning == true && bDoorClose == true)
+\param szCommand typed command
+\returns true if command has been done
+*/
+bool WorkOnProgramCommands(char szCommand[])
+{
+  if ( szCommand[0] != 'S' )
+    return false;
+  if ( szCommand[1] == '=' )
   {
-    if(isFilled == false)
+    if ( ! StartWashProgram(atoi(szCommand+2)) )
+      Serial.println(F("# unknown program"));
+    return true;                                // done
+  }
+  if ( szCommand[1] == '?' )
+  {
+    Serial.print(F("S="));
+    Serial.print(isRunning ? nWashProgram : 0);
+    Serial.print(F(" step="));
+    Serial.print(nWashStepIndex);
+    Serial.print(F(" overlap="));
+    Serial.print(bPhaseOverlap);
+    Serial.print(F(" ahead="));
+    PrintOverlapAhead();
+    Serial.println();
+    return true;                                // done
+  }
+  if ( ( szCommand[1] == 'o' ) && ( szCommand[2] == '=' ) )
+  {
+    bPhaseOverlap = ( atoi(szCommand+3) != 0 );
+    return true;                                // done
+  }
+  return false;
+}
+
+#if PROFILER_ENABLED
+//! Compare response value parsing
+/*!
+Compare the former floating point path, atof() and a double compare,
+with ParseFixed() and an integer compare on typical response values.
+Prints the average CPU cycles per value for both.
+Takes some ten msec, so use it for measurements only.
+
+The samples are copied into RAM through a volatile pointer first,
+so the compiler cannot fold the parsing of the constant literals, not even with LTO.
+*/
+void BenchmarkParsing()
+{
+  static const char * const Samples[] = { "23.45", "1.300", "60.2", "0.05", "118.37" };
+  const int       nSamples = sizeof(Samples) / sizeof(Samples[0]);
+  const int       nRounds = 50;
+  volatile bool   bResult;                      // keep the compiler from removing the work
+  char            szValues[nSamples][8];        // runtime copies of the samples
+
+  for ( int i = 0; i < nSamples; ++i )
+  {
+    const char * volatile pszSample = Samples[i];
+    strncpy(szValues[i], pszSample, sizeof(szValues[i]) - 1);
+    szValues[i][sizeof(szValues[i]) - 1] = 0;
+  }
+
+  unsigned long usecStart = micros();
+  for ( int r = 0; r < nRounds; ++r )
+    for ( int i = 0; i < nSamples; ++i )
+      bResult = ( atof(szValues[i]) < 60.0 );
+  unsigned long usecFloat = micros() - usecStart;
+
+  usecStart = micros();
+  for ( int r = 0; r < nRounds; ++r )
+    for ( int i = 0; i < nSamples; ++i )
+      bResult = ( ParseFixed(szValues[i], 2) < 6000 );
+  unsigned long usecFixed = micros() - usecStart;
+  (void)bResult;
+
+  Serial.print(F("# cycles/value atof="));
+  Serial.print(usecFloat * clockCyclesPerMicrosecond() / ( nRounds * nSamples ));
+  Serial.print(F(" fixed="));
+  Serial.println(usecFixed * clockCyclesPerMicrosecond() / ( nRounds * nSamples ));
+}
+#endif
+
+//! Handle diagnostic commands
+/*!
+Handle diagnostic commands of the controller itself.
+
+- "s?" show scheduler statistics
+- "s=0" reset scheduler statistics
+- "a?" show poll scheduler statistics and setpoint shadow registers
+- "a=0" reset poll scheduler statistics
+- "i?" show I²C statistics
+- "i=0" reset I²C statistics
+- "b=n" binary telemetry with n frames per second, 0 switches back to text
+- "b?" show binary telemetry rate and skipped frames
+- "c=1" record the I²C transactions on Serial, from the next results taken on, starting with a state record, "c=0" stops recording
+- "c?" show recorded and dropped records
+- "p?" show execution time profile, if compiled with PROFILER_ENABLED
+- "p=0" reset execution time profile
+- "f?" compare CPU cycles of atof() and ParseFixed(), if compiled with PROFILER_ENABLED
+
+\param szCommand typed command
+\returns true if command has been done
+*/
+bool WorkOnDiagnosticCommands(char szCommand[])
+{
+  if ( szCommand[0] == 's' )
+  {
+    if ( szCommand[1] == '?' )
     {
-      handleWater(targetWaterLevel);
-      //Serial.println("Handle Water wurde ausgeführt");
-      isFilled = true;
+      Scheduler_PrintStats(Serial);
+      Serial.print(F("# commands dropped="));
+      Serial.println(Command_Dropped());
     }
-
-    // Wassertemperatur einstellen
-    if(temp100.check())
+    else if ( szCommand[1] == '=' )
+      Scheduler_ResetStats();
+    else
+      return false;
+    return true;                                // done
+  }
+  if ( szCommand[0] == 'a' )
+  {
+    if ( szCommand[1] == '?' )
     {
-      handleTemp(targetTemperature);
-      //Serial.println("Handle Temp wurde ausgeführt");
+      Poll_PrintStats(Serial);
+      Setpoint_PrintStats(Serial);
     }
-
-    // Daten aktualisieren
-    if(akt_data.check())
+    else if ( szCommand[1] == '=' )
+      Poll_ResetStats();
+    else
+      return false;
+    return true;                                // done
+  }
+  if ( szCommand[0] == 'i' )
+  {
+    if ( szCommand[1] == '?' )
     {
-      Task_100ms();
-      //Serial.println("100ms Task wurde ausgeführt!");
+      I2C_PrintStats(Serial);
+      Serial.print(F("# protocol="));
+      Serial.print(nPlantProtocol);           // 0 for ASCII
+      Serial.print(F(" fallbacks="));
+      Serial.println(nBinaryFallbacks);
     }
-
-    if(display_data.check())
+    else if ( ( szCommand[1] == '=' ) && ( atoi(szCommand+2) > 0 ) )
+      I2C_SetFrequency(atol(szCommand+2) * 1000L); // bus speed in kHz
+    else if ( szCommand[1] == '=' )
+      I2C_ResetStats();
+    else
+      return false;
+    return true;                                // done
+  }
+  if ( ( szCommand[0] == 'x' ) && ( szCommand[1] == '?' ) )
+  {
+    I2C_PrintTrace(Serial);
+    return true;                                // done
+  }
+  if ( szCommand[0] == 'b' )
+  {
+    if ( szCommand[1] == '=' )
+      Telemetry_SetRate(atoi(szCommand+2));
+    else if ( szCommand[1] == '?' )
     {
-      ShowData();
+      Serial.print(F("# b="));
+      Serial.print(Telemetry_Rate());
+      Serial.print(F(" skipped="));
+      Serial.println(Telemetry_Skipped());
     }
-
-    if(hundert.check())
+    else
+      return false;
+    return true;                                // done
+  }
+  if ( szCommand[0] == 'c' )
+  {
+    if ( szCommand[1] == '=' )
     {
-      door();
-      //Serial.println("Tür-Sensor aktualisiert");
+      bStartRecorder = ( atoi(szCommand+2) != 0 ); // started by Task_100ms() with the state record
+      if ( ! bStartRecorder )
+        I2C_SetRecorder(nullptr);
     }
-
-    if(rpmtime.check())
+    else if ( szCommand[1] == '?' )
     {
-      if(rpmONOFF == true)
-      {
-        CreateNextSteadyCommand("r=800");
-        Task_100ms();
-        I2C_Master_Steady();                          // give background processing a chance
-        Serial.println("Drehzahl An");
-        rpmONOFF = !rpmONOFF;
-      }
-      else
-      {
-        CreateNextSteadyCommand("r=0");
-        Task_100ms();
-        I2C_Master_Steady();                          // give background processing a chance
-        Serial.println("Drehzahl Aus");
-        rpmONOFF = !rpmONOFF;
-      }
+      unsigned long nDropped;
+      Serial.print(F("# c records="));
+      Serial.print(I2C_Recorded(&nDropped));
+      Serial.print(F(" dropped="));
+      Serial.println(nDropped);
     }
+    else
+      return false;
+    return true;                                // done
+  }
+#if PROFILER_ENABLED
+  if ( ( szCommand[0] == 'f' ) && ( szCommand[1] == '?' ) )
+  {
+    BenchmarkParsing();
+    return true;                                // done
+  }
+  if ( szCommand[0] == 'p' )
+  {
+    if ( szCommand[1] == '?' )
+      Profiler_Print(Serial);
+    else if ( szCommand[1] == '=' )
+      Profiler_Reset();
+    else
+      return false;
+    return true;                                // done
+  }
+#endif
+  return false;
+}
 
-    if(wp1_duration.check())
+//! Work on typed commands until one is for the plant
+/*!
+Work on all typed commands done by the controller itself in their order
+and stop at the first command which has to go to the plant.
+Assignments to plant setpoints go to the setpoint shadow registers.
+
+\param szCommand storage for a typed command
+\param nCommandLengthMax size of szCommand
+\returns true if a command for the plant has been typed
+*/
+bool CheckIfTypedForPlant(char szCommand[], int nCommandLengthMax)
+{
+  while ( CheckIfTypedAvailable(szCommand, nCommandLengthMax) )
+  {
+    if ( szCommand[0] == 'R' )                  // check special case first
     {
-      isRunning = false;
-      Serial.println("isRunning ist auf false gesetzt worden!!! (WP1 beendet!)");
-      WorkOnCommandsForDigitalIO("P=1");
-        Task_100ms();
-        I2C_Master_Steady();                          // give background processing a chance
-        delay(5000);
-        WorkOnCommandsForDigitalIO("P=0");
-        Task_100ms();
-        I2C_Master_Steady();                          // give background processing a chance
-        CreateNextSteadyCommand("r=0");
-        Task_100ms();
-        I2C_Master_Steady();                          // give background processing a chance
+      ResetIO();                                // the reset command, goes to I²C as well
+      Setpoint_Invalidate();                    // plant forgets its setpoints
+      bQueryProtocol = true;                    // and possibly its protocol
+      nChangeStatus = CS_UNKNOWN;
+      Poll_SetChangeDriven(false);
+      return true;
+    }
+    int   nSetpoint = Setpoint_Find(szCommand);
+    if ( nSetpoint >= 0 )
+    {                                           // setpoint, written by the shadow registers
+      Setpoint_Set(nSetpoint, atoi(szCommand+2), true);
+      continue;
     }
+    if ( ! WorkOnLocalCommands(szCommand) )
+      return true;                              // all remaining commands go to I²C
   }
+  return false;
+}
 
+//! Handle all commands done by the controller itself
+/*!
+Handle all commands done by the controller itself: digital IO, wash program and diagnostics.
+
+\param szCommand typed command
+\returns true if command has been done, false if it has to go to the plant
+*/
+bool WorkOnLocalCommands(char szCommand[])
+{
+  return (   WorkOnCommandsForDigitalIO(szCommand) // check if command for digital IO
+          || WorkOnProgramCommands(szCommand)   // check if command for the wash program
+          || WorkOnDiagnosticCommands(szCommand) ); // check if command for diagnostics
 }
 
 //! Show some data values
@@ -577,127 +1387,256 @@ Remember, each character at 115200 Baud requires about 0.1 msec.
 */
 void ShowData()
 {                                               // just to show a result
-  Serial.print("T=");
-  Serial.print(dTime);                          // time in min
-  Serial.print(" C=");
-  Serial.print(dTemperature);
-  Serial.print(" A=");
-  Serial.print(dWaterLevel);
-  Serial.print(" w=");
-  Serial.print(dWasserInWaesche);
-  Serial.print(" D=");
+  Serial.print(F("T="));
+  PrintFixed(Serial, nTime, 2);                 // time in min
+  Serial.print(F(" C="));
+  PrintFixed(Serial, nTemperature, 2);
+  Serial.print(F(" A="));
+  PrintFixed(Serial, nWaterLevel, 3);
+  Serial.print(F(" w="));
+  PrintFixed(Serial, nWasserInWaesche, 3);
+  Serial.print(F(" D="));
   Serial.print(digitalRead(nDoorClosed));
-  Serial.print(" RPM=");
+  Serial.print(F(" RPM="));
   Serial.print(drpm);
-  Serial.print(" L=");
+  Serial.print(F(" L="));
   Serial.print(dWaeschemenge);
-  Serial.print(" O=");
+  Serial.print(F(" O="));
   Serial.print(dWaschmittelmenge);
-  Serial.print(" W=0x");
+  Serial.print(F(" W=0x"));
   Serial.print(nWarnings, HEX);
-  Serial.println("");
+  Serial.println();
+}
+
+//! Send a binary telemetry frame
+/*!
+Send a binary telemetry frame with the current values, see \link Telemetry Binary Telemetry \endlink.
+*/
+void SendTelemetry()
+{
+  TelemetryData data;
+  data.nPlantTime = nTime;
+  data.nTemperature = nTemperature;
+  data.nWaterLevel = nWaterLevel;
+  data.nWaterInLaundry = nWasserInWaesche;
+  data.nRpm = drpm;
+  data.nLaundry = dWaeschemenge;
+  data.nDetergent = dWaschmittelmenge;
+  data.nWarnings = nWarnings;
+  data.nIOBits = ( digitalRead(nWaterIntake) ? TM_WATER_INTAKE : 0 )
+               | ( digitalRead(nWaterPump) ? TM_WATER_PUMP : 0 )
+               | ( digitalRead(nHeating) ? TM_HEATING : 0 )
+               | ( bDoorClose ? TM_DOOR_CLOSED : 0 )
+               | ( isRunning ? TM_RUNNING : 0 );
+  data.nProgram = nWashProgram;
+  data.nStep = nWashStepIndex;
+  Telemetry_Send(Serial, data);
 }
 
 //! Function Task_10ms called every 10 msec
 void Task_10ms()
 {
-  ;                                              // nothing to do so far
+  PROFILE_BEGIN(PROF_TASK_10MS);
+  door();                                       // take door sensor state
+  if ( ( nChangeStatus == CS_ON ) && ( digitalRead(nPlantAttention) == LOW ) )
+    QueueNextPoll();                            // plant asks for attention, read its change status now
+  if ( Telemetry_Due() )
+    SendTelemetry();                            // binary telemetry at its own rate
+  PROFILE_END(PROF_TASK_10MS);
 }
 
-//! Function Task_100ms called every 100 msec
+//! Handle an I²C result
 /*!
-I²C communication and keyboard input.
- */
-void Task_100ms()
+Handle an I²C result, a response or a timeout, according to the tag of its request.
 
+\param nResult result of I2C_Fetch(), all requests go to the plant
+\param nTag tag of the request, see RequestTag
+\param szResponse response, empty on timeout
+*/
+void HandleResult(int nResult, uint8_t nTag, char szResponse[])
 {
-  
-  static char  szCommand[I2C_DATA_MAX+1];       // buffer for commands
-  static char  szResponse[I2C_DATA_MAX+1];      // buffer for responses
-  static bool  bOperatesCommand = false;        // flag tells if request is under way
-
-  if ( ! bOperatesCommand )                     // if not busy at working on a current command
+  const uint8_t * pFrame = (const uint8_t *)szResponse;
+  bool  bBinary = ( nResult > 0 ) && ( Binary_Version(pFrame, nResult) > 0 );
+  if ( ( nTag & TAG_BINARY ) && ( nResult > 0 ) && ! bBinary )
+  {                                             // binary request answered in ASCII, old plant
+    nPlantProtocol = 0;
+    ++nBinaryFallbacks;
+  }
+  switch ( nTag & TAG_CLASS )
   {
-    if ( CheckIfTypedAvailable(szCommand, I2C_DATA_MAX+1) )
+  case TAG_SETPOINT:
+    if ( bBinary )
+    {                                           // the acknowledge is the only entry
+      char  cId = 0;
+      long  nValue = 0;
+      Binary_Next(pFrame, nResult, 1, &cId, &nValue);
+      Setpoint_Acknowledge(nTag & ~( TAG_CLASS | TAG_BINARY ), cId, nValue);
+    }
+    else
+      Setpoint_Complete(nTag & ~( TAG_CLASS | TAG_BINARY ), ( nResult >= 0 ) ? szResponse : nullptr);
+    break;
+  case TAG_POLL:
+    bStatusSeen = false;
+    if ( bBinary )
+      InterpreteBinary(pFrame, nResult);
+    else if ( nResult >= 0 )
+      InterpreteResponse(szResponse);
+    if ( ( nTag & TAG_STATUS ) && ( nResult >= 0 ) && ! bStatusSeen )
+      TakeChangeStatus(0);                      // change status ignored, old plant
+    Poll_Complete(nResult >= 0);                // check batch for missing values
+    break;
+  case TAG_MANUAL:
+    if ( ( nResult >= 0 ) && ! InterpreteResponse(szResponse) )
     {
-      bOperatesCommand = true;                  // we have a new manual command to work on
+#if 1                                           // possibly disable
+      Serial.print(F(" -> "));                  // show not handled command and response
+      Serial.println(szResponse);
+#endif
     }
-    else if ( CreateNextSteadyCommand(szCommand) )
+    break;
+  default:                                      // TAG_NOREPLY, TAG_QUERY
+    if ( nTag == TAG_QUERY )
     {
-      bOperatesCommand = true;                  // we have a new generated command to work on
+      nPlantProtocol = ( nResult > 0 ) ? Binary_ParseVersion(szResponse) : 0;
+      bQueryOutstanding = false;
     }
+    break;
   }
+  // timeouts are counted per slave and kept in the trace, see I2C_PrintStats() and I2C_PrintTrace()
+}
 
-  // check for direct IO commands to physical ports 
-  if ( bOperatesCommand )                       // working on a current command
+//! text of requests and responses, shared by QueueNextPoll() and Task_100ms(), never both at a time
+char            szPlantText[I2C_DATA_MAX+1];
+
+//! Queue a request for the plant
+/*!
+Queue a poll or setpoint write for the plant, as binary frame if the plant knows the binary protocol.
+
+\param pszRequest ASCII request, e.g. "T?C?" or "r=800"
+\param nPriority see I2C_Priority
+\param nTag see RequestTag
+\param nRetries repeats after a timeout
+\returns see I2C_Queue()
+*/
+int QueuePlantRequest(const char * pszRequest, uint8_t nPriority, uint8_t nTag, uint8_t nRetries)
+{
+  uint8_t       Frame[I2C_DATA_MAX];            // binary request, the slot keeps a copy
+  int   nLength = ( nPlantProtocol > 0 ) ? Binary_FromText(pszRequest, Frame, sizeof(Frame), nPlantProtocol) : -1;
+  if ( nLength < 0 )
+    return I2C_Queue(I2C_PLANT_ADDR, pszRequest, nPriority, nTag, nRetries);
+  return I2C_QueueData(I2C_PLANT_ADDR, Frame, nLength, nPriority, nTag | TAG_BINARY, nRetries);
+}
+
+//! Queue the next poll
+/*!
+Queue the next poll for the plant, one poll at a time.
+Not before the result of the last poll has been handled, it completes the batch of the poll scheduler.
+*/
+void QueueNextPoll()
+{
+  if ( ( I2C_Queued(I2C_PRIO_POLL) == 0 ) && ! I2C_HasReply() && I2C_IsReady(I2C_PRIO_POLL) )
   {
-    if ( szCommand[0] == 'R' )                  // check special case first
-    {
-      ResetIO();                                // the reset command
-    }
-    else if ( WorkOnCommandsForDigitalIO(szCommand) ) // check if command for digital IO
+    uint8_t nTag = ( nChangeStatus != CS_OFF ) ? TAG_POLL | TAG_STATUS : TAG_POLL;
+    if ( CreateNextSteadyCommand(szPlantText) )
+      QueuePlantRequest(szPlantText, I2C_PRIO_POLL, nTag, I2C_RETRIES_MAX);
+  }
+}
+
+//! Function Task_100ms called every 100 msec
+/*!
+I²C communication and keyboard input.
+
+Queues changed setpoints, typed commands for the plant and one poll at a time, see \link I2C_Master I2C_Master \endlink.
+The I²C master serves them back to back by priority from loop(),
+the results are handled here as they come in.
+ */
+void Task_100ms()
+{
+  PROFILE_BEGIN(PROF_TASK_100MS);
+
+  RunWashProgram();                             // advance wash program by one step
+
+  int           nSetpoint;
+  while ( ( nSetpoint = Setpoint_Peek() ) >= 0 )
+  {                                             // changed or unacknowledged setpoints first
+    uint8_t nPriority = (   ( nSetpoint == SP_DOOR )
+                         || ( ( nSetpoint == SP_DRUM ) && ( Setpoint_Desired(SP_DRUM) == 0 ) ) )
+                        ? I2C_PRIO_SAFETY : I2C_PRIO_SETPOINT;
+    if ( ! I2C_IsReady(nPriority) )
+      break;                                    // no room at its priority, still pending
+    nSetpoint = Setpoint_Next(szPlantText);
+    uint8_t nRetries = ( ( nSetpoint == SP_DOOR ) || ( nSetpoint == SP_DRUM ) )
+                       ? I2C_RETRIES_MAX : 0;   // states may be written twice, doses not
+    if ( QueuePlantRequest(szPlantText, nPriority, TAG_SETPOINT | nSetpoint, nRetries) < 0 )
     {
-      bOperatesCommand = false;                 // command has been done by IO assignment
+      Setpoint_Withdraw(nSetpoint);             // not sent, try again later
+      break;
     }
-    // all remaining commands go to I²C, see below
   }
 
-  if ( bOperatesCommand )                       // working on a current command
-  {
-    *szResponse = 0;                            // clean response
-    int           nRes;
-    nRes = I2C_SendRequest(I2C_PLANT_ADDR, szCommand); // request something from I²C slave
-    if ( nRes == -2 )
-      Serial.println("request too long");
-    if ( *szCommand == 'R' )                    // handle special "reset" request
-      bOperatesCommand = false;                 // no response expected after reset
+  while ( I2C_IsReady(I2C_PRIO_SETPOINT) && CheckIfTypedForPlant(szPlantText, I2C_DATA_MAX+1) )
+  {                                             // manual commands
+    uint8_t nTag = ( *szPlantText == 'R' ) ? TAG_NOREPLY : TAG_MANUAL; // no response expected after reset
+    I2C_Queue(I2C_PLANT_ADDR, szPlantText, I2C_PRIO_SETPOINT, nTag); // too long is counted per slave
   }
 
-  long          nResponseTime;
-  int           nSlaveNo;
-  int           nResult = I2C_GetResponse(&nSlaveNo, szResponse, &nResponseTime);
-  if ( nResult >= 0 )
-  {
-    if ( ! InterpreteResponse(szResponse) )     // use response we got
+  if ( bQueryProtocol && I2C_IsReady(I2C_PRIO_SETPOINT) )
+  {                                             // ask for the binary protocol, ASCII until answered
+    nPlantProtocol = 0;
+    if ( I2C_Queue(I2C_PLANT_ADDR, BINARY_QUERY, I2C_PRIO_SETPOINT, TAG_QUERY, I2C_RETRIES_MAX) >= 0 )
     {
-#if 1                                           // possibly disable
-      Serial.print(" -> ");                     // show not handled command and response
-      Serial.println(szResponse);
-#endif
+      bQueryProtocol = false;
+      bQueryOutstanding = true;
     }
-    bOperatesCommand = false;                   // note command complete done
   }
-  else if ( nResult == -1 )
-    ;//Serial.println("busy");
-  else if ( nResult == -3 )
-  {
-    Serial.print(nSlaveNo);
-    Serial.println(":timeout");
-    bOperatesCommand = false;                   // note command complete done
+
+  int           nResult;
+  int           nSlaveNo;
+  uint8_t       nTag;
+  while ( ( nResult = I2C_Fetch(&nSlaveNo, &nTag, szPlantText) ) != -4 )
+  {                                             // all results
+    PROFILE_BEGIN(PROF_INTERPRETE);
+    HandleResult(nResult, nTag, szPlantText);
+    PROFILE_END(PROF_INTERPRETE);
   }
-  else if ( nResult == -4 )
-    ;//Serial.println("no response yet");
-    
-   //Serial.print("test test 123");
+  if ( bStartRecorder )
+    StartRecorder();                            // all results taken
+
+  QueueNextPoll();                              // one poll at a time, after the last poll result
+  PROFILE_END(PROF_TASK_100MS);
 }
 
 //! Function Task_1s called every 1 sec
 /*!
 Use communication verbose flag (-v) to remove all but pure values.
 This allows to use the integrated Arduino serial plotter or an external software like gnuplot.
+Commands dropped by the command input are reported once a second, see \link CommandInput Command Input \endlink.
 */
 void Task_1s()
 {
+  PROFILE_BEGIN(PROF_TASK_1S);
  // zeit ++;                                  // Timer
 
   ToggleDigitalIOPort(LEDpin);                  // toggle output to LED
 
-  ShowData();                                   // possibly remove later
+  if ( Telemetry_Rate() == 0 )                  // text only without binary telemetry
+  {
+    PROFILE_BEGIN(PROF_SHOWDATA);
+    ShowData();                                 // possibly remove later
+    PROFILE_END(PROF_SHOWDATA);
+  }
 
    //door();                                      // Türzustand senden
 
+  static unsigned int nDroppedShown = 0;        // dropped commands reported so far
+  if ( Command_Dropped() != nDroppedShown )
+  {                                             // the sender was too fast, see CommandInput
+    nDroppedShown = Command_Dropped();
+    Serial.print(F("# commands dropped="));
+    Serial.println(nDroppedShown);
+  }
 
-
+  PROFILE_END(PROF_TASK_1S);
 }
 
 /*!
@@ -714,32 +1653,21 @@ This function will be called again and again as fast as possible.
 
 It will dispatch the CPU power between tasks which are expected to be executed in some regular intervals.
 Such intervals are often called sampling time.
+The intervals are defined in the task table Tasks, see \link Scheduler Scheduler \endlink.
 */
 void loop()
 {
-  static char   szCommand[I2C_DATA_MAX+1];       // buffer for commands
-
-  long  msecCurrentMillis = millis();
-  if ( ( msecCurrentMillis - msecPreviousMillis ) < 10 )
-    return;
-  msecPreviousMillis = msecCurrentMillis;
+  static LineAssembler  SerialLine;             // command line from COM port
+  static LineAssembler  EspLine;                // command line from ESP
 
-  Task_10ms();                                  // call user 10 msec function
-  if ( ++nCount10msec >= 10 )
-  {
-    nCount10msec = 0;
-    Task_100ms();                               // call user 100 msec function
-    if ( ++nCount100msec >= 10 )
-    {
-      nCount100msec = 0;
-      Task_1s();                                // call user 1 sec function
-    }
-  }
-  waschprogramm1();
+  PROFILE_BEGIN(PROF_LOOP);
+  Command_Poll(Serial, SerialLine);             // collect typed characters
+  Command_Poll(esp_uno, EspLine);
+  Scheduler_Run();                              // call at most one due task
 /*!
   if(sekunde.check())
   {
-  esp_uno.write("test test 123");               // send to esp via SoftwareSerial
+  esp_uno.print(F("test test 123"));            // send to esp via SoftwareSerial
   }
 
   if(Serial.available())
@@ -752,12 +1680,15 @@ void loop()
   }
   */
 
+  PROFILE_BEGIN(PROF_I2C_STEADY);
   I2C_Master_Steady();                          // give background processing a chance
+  PROFILE_END(PROF_I2C_STEADY);
+  PROFILE_END(PROF_LOOP);
   //delay(1);
 /*!
   msgOut = digitalRead(nHeating) + ';' + digitalRead(nWaterPump) + ';' + drpm + ';' + dTemperature + ';' + digitalRead(nDoorClosed) + ';' + dWaschmittelmenge + ';' + dWaterLevel + ';' + digitalRead(nWaterIntake);
   esp_uno.print(msgOut);
-  esp_uno.println("\n");
+  esp_uno.println(F("\n"));
 
   while(esp_uno.available() > 0)
   {
@@ -0,0 +1,78 @@
+/* Interrupt driven door sensor
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include door sensor
+#include "DoorSensor.h"
+
+                                                // door sensor data
+//! door switch pin
+static int            nDoorPin = -1;
+//! interlock function called on opening
+static void           (*pfnDoorOnOpen)() = nullptr;
+//! debounced state, true if closed
+static volatile bool  bDoorClosed = false;
+//! state change not yet taken
+static volatile bool  bDoorChanged = false;
+//! equal samples differing from the debounced state
+static uint8_t        nDoorSamples = 0;
+
+// Door sensor setup
+void Door_Setup(int nPin, void (*pfnOnOpen)())
+{
+  nDoorPin = nPin;
+  pfnDoorOnOpen = pfnOnOpen;
+  pinMode(nDoorPin, INPUT_PULLUP);
+  bDoorClosed = ( digitalRead(nDoorPin) == LOW );
+  bDoorChanged = true;                          // report initial state
+#if defined(__AVR__)
+  OCR0B = 0x80;                                 // half way between millis() overflows
+  TIMSK0 |= _BV(OCIE0B);                        // start sampling
+#endif
+}
+
+// Sample the door switch
+void Door_Sample()
+{
+  if ( nDoorPin < 0 )
+    return;                                     // not set up
+  bool  bClosed = ( digitalRead(nDoorPin) == LOW );
+  if ( bClosed == bDoorClosed )
+  {
+    nDoorSamples = 0;                           // bounce or no change
+    return;
+  }
+  if ( ++nDoorSamples < DOOR_DEBOUNCE_MS )
+    return;                                     // not yet stable
+  nDoorSamples = 0;
+  bDoorClosed = bClosed;
+  bDoorChanged = true;
+  if ( ( ! bClosed ) && ( pfnDoorOnOpen != nullptr ) )
+    pfnDoorOnOpen();                            // interlock right now
+}
+
+// Debounced door state
+bool Door_IsClosed()
+{
+  return bDoorClosed;
+}
+
+// Take a door state change
+bool Door_TakeChange(bool * pbClosed)
+{
+  noInterrupts();                               // flag and state of the same sample
+  bool  bChanged = bDoorChanged;
+  bDoorChanged = false;
+  *pbClosed = bDoorClosed;
+  interrupts();
+  return bChanged;
+}
+
+#if defined(__AVR__)
+//! Door sampling, about every msec
+ISR(TIMER0_COMPB_vect)
+{
+  Door_Sample();
+}
+#endif
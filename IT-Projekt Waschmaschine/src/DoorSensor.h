@@ -0,0 +1,54 @@
+/*! \page DoorSensor Door Sensor
+Interrupt driven door sensor with debouncing and interlock.
+
+The door switch is sampled about every millisecond from the TIMER0_COMPB interrupt.
+Timer 0 already runs for millis(), its compare unit B is free.
+Pin change interrupts cannot be used as SoftwareSerial occupies all pin change vectors.
+
+A new switch state is accepted after DOOR_DEBOUNCE_MS equal samples.
+On a debounced opening the interlock function is called immediately from the interrupt,
+it has to be short and must not use Serial or I²C.
+The change is also noted for the tasks, see Door_TakeChange().
+
+The switch connects the pin to ground while the door is closed, the pin uses its pullup.
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // door sensor attributes
+//! equal samples required for a new state, about msec
+const uint8_t   DOOR_DEBOUNCE_MS = 5;
+
+                                                // door sensor prototypes
+//! Door sensor setup
+/*!
+Door sensor setup, starts sampling.
+\param nPin door switch input pin
+\param pfnOnOpen interlock function called from the interrupt when the door opens, may be nullptr
+*/
+extern void Door_Setup(int nPin, void (*pfnOnOpen)());
+
+//! Sample the door switch
+/*!
+Sample the door switch once.
+Called from the timer interrupt, to be called every msec on platforms without it.
+*/
+extern void Door_Sample();
+
+//! Debounced door state
+/*!
+Debounced door state.
+\return true if the door is closed
+*/
+extern bool Door_IsClosed();
+
+//! Take a door state change
+/*!
+See if the debounced door state changed since the last call.
+Flag and state are taken together with interrupts off,
+so a change right now is either taken with its state or left for the next call.
+\param pbClosed storage for the debounced state, true if closed, set in any case
+\return true once after every change
+*/
+extern bool Door_TakeChange(bool * pbClosed);
@@ -0,0 +1,59 @@
+/* Fixed point parsing and printing of decimal values
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include fixed point values
+#include "FixedPoint.h"
+
+// Parse a decimal number into a scaled integer
+long ParseFixed(const char * psz, uint8_t nDecimals)
+{
+  while ( *psz == ' ' )
+    ++psz;                                      // skip blanks
+  bool  bNegative = ( *psz == '-' );
+  if ( ( *psz == '-' ) || ( *psz == '+' ) )
+    ++psz;
+
+  long  nValue = 0;
+  while ( ( *psz >= '0' ) && ( *psz <= '9' ) )
+    nValue = nValue * 10 + ( *psz++ - '0' );    // integer part
+
+  uint8_t nDigits = 0;
+  if ( *psz == '.' )
+  {
+    ++psz;
+    while ( ( *psz >= '0' ) && ( *psz <= '9' ) && ( nDigits < nDecimals ) )
+    {
+      nValue = nValue * 10 + ( *psz++ - '0' );  // kept decimals
+      ++nDigits;
+    }
+    if ( ( *psz >= '5' ) && ( *psz <= '9' ) )
+      ++nValue;                                 // round first dropped digit
+  }
+  for ( ; nDigits < nDecimals; ++nDigits )
+    nValue *= 10;                               // missing decimals
+
+  return bNegative ? -nValue : nValue;
+}
+
+// Print a scaled integer as decimal number
+void PrintFixed(Print & out, long nValue, uint8_t nDecimals)
+{
+  if ( nValue < 0 )
+  {
+    out.print('-');
+    nValue = -nValue;
+  }
+  long  nScale = 1;
+  for ( uint8_t i = 0; i < nDecimals; ++i )
+    nScale *= 10;
+  out.print(nValue / nScale);
+  if ( nDecimals == 0 )
+    return;
+  out.print('.');
+  long  nFraction = nValue % nScale;
+  for ( nScale /= 10; nScale > nFraction && nScale > 1; nScale /= 10 )
+    out.print('0');                             // leading zeros of the fraction
+  out.print(nFraction);
+}
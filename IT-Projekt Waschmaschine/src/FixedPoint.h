@@ -0,0 +1,38 @@
+/*! \page FixedPoint Fixed Point Values
+Fixed point parsing and printing of decimal values.
+
+The ATmega328 has no floating point unit, atof() and double arithmetic are done in software.
+Plant values are therefore kept as scaled integers:
+
+<table border="0" width="80%">
+<tr><td> time        </td><td> 0.01 min </td><td> long </td></tr>
+<tr><td> temperature </td><td> 0.01 °C  </td><td> int  </td></tr>
+<tr><td> water       </td><td> g        </td><td> int  </td></tr>
+</table>
+
+ParseFixed() converts a decimal text like "23.45" directly into such an integer,
+digits beyond the requested decimals are rounded.
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // fixed point prototypes
+//! Parse a decimal number into a scaled integer
+/*!
+Parse a decimal number into a scaled integer, e.g. "23.456" with 2 decimals gives 2346.
+Leading blanks and a sign are accepted, parsing stops at the first other character.
+\param psz text to parse
+\param nDecimals decimals to keep, the result is scaled by 10^nDecimals
+\return scaled value, 0 if there is no number
+*/
+extern long ParseFixed(const char * psz, uint8_t nDecimals);
+
+//! Print a scaled integer as decimal number
+/*!
+Print a scaled integer as decimal number without using floating point.
+\param out output stream, typically Serial
+\param nValue scaled value
+\param nDecimals decimals of the scaled value
+*/
+extern void PrintFixed(Print & out, long nValue, uint8_t nDecimals);
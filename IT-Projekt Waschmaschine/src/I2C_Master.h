@@ -1,75 +1,390 @@
-/*! \page I2C_Master I2C Master
-Arduino I²C Master.
-
-This I²C master uses a request/response scheme.
-Response from a slave should always answer the last request.
-
-<pre>
-(c)2015-2020 IngenieurbÃ¼ro Dr. Friedrich Haase
-             Consulting - Automatisierungstechnik
-</pre>
-
-<pre>
-<b>Versions</b>
-July 2015  Dr. Haase  created
-Sept 2015  Dr. Haase  converted for IT project
-Aug 2020   Dr. F. Haase  complete redesign
-</pre>
-*/
-
-// include standard Arduino library
-#include <Arduino.h>
-// include standard I²C library
-#include <Wire.h>
-
-                                                // I²C attributes
-//! max request and response length
-const int       I2C_DATA_MAX = 132;
-
-                                                // I²C prototypes
-//! I²C master setup
-/*!
-I²C master setup
-\param nFrequency I2C frequency
-*/
-extern void I2C_Master_Setup(long nFrequency);
-
-//! I²C master steady call
-/*!
-I²C master steady call
-*/
-extern void I2C_Master_Steady();
-
-//! Send request to slave
-/*!
-Send request to slave.
-Expects a response.
-\param nSlaveNo target slave number for the request
-\param pszRequest request message, may be nullptr
-\return >=0 on success, -1 if busy, -2 if too long
-*/
-extern int I2C_SendRequest(int nSlaveNo, const char * const pszRequest);
-
-//! Get text response for last request
-/*!
-Gets a received text response.
-\param pnSlaveNo slave number the request was targeted
-\param pszResponse storage for received response
-\param pnResponseTime duration between request transmit start and response delivery in microseconds
-\returns >=0 length on success, -1 if busy, -3 if timed out, -4 while no outstanding response
-*/
-extern int I2C_GetResponse(int * pnSlaveNo, char * pszResponse, unsigned long * pnResponseTime = nullptr);
-
-//! See if ready for a request
-/*!
-See if ready for a request.
-\return true if I2C is ready
-*/
-extern bool I2C_IsReady();
-
-//! See if request has been fulfilled
-/*!
-See if request has been fulfilled.
-\return true if I2C previous command got a reply
-*/
-extern bool I2C_HasReply();
+/*! \page I2C_Master I2C Master
+Arduino I²C Master.
+
+This I²C master uses a request/response scheme.
+Response from a slave should always answer the last request.
+
+Requests are queued in I2C_QUEUE_SIZE slots, each with its own slave address, priority class and tag.
+The master serves them back to back, the highest priority class first, the oldest first within a class.
+The last free slot is kept for I2C_PRIO_SAFETY, so a safety write always gets in.
+Results, responses or timeouts, are fetched in the order of completion by I2C_Fetch() together with the tag of their request.
+A request and its response share the slot, so both are limited to I2C_DATA_MAX.
+Requests and length prefixed responses may be binary, responses get a trailing 0 for text use.
+
+The master never waits on the bus.
+The transfers run in the TWI interrupt, see \link TwiMaster TWI Master Driver \endlink,
+and I2C_Master_Steady() only advances the transaction when a transfer is complete,
+so loop() keeps running thousands of times per second.
+Between request and response the slave gets I2C_RESPONSE_GAP_US to prepare its response.
+With a gap of 0 request and response are done in one transfer with a repeated start.
+
+Responses are read in two phases.
+First a single header byte 0x80 + length, then exactly that many payload bytes,
+in chunks of at most I2C_CHUNK_MAX bytes, so responses longer than the receive buffer are read transparently.
+A short answer like "C=60.2" costs 1 + 6 bytes on the bus instead of a padded 32 byte frame.
+A slave answering with ASCII right away (header byte below 0x80) has no length prefix,
+the master then reads I2C_RESPONSE_MAX bytes as before for this and all further responses.
+
+The response timeout adapts to each slave.
+The master keeps a smoothed round trip time and its mean deviation per slave, as TCP does,
+and allows avg + 4 * dev, at least I2C_TIMEOUT_MIN_US and at most I2C_TIMEOUT_MAX_US.
+After a timeout the allowance of the slave is doubled, up to I2C_TIMEOUT_MAX_US, until the next response.
+A request queued with retries is repeated after a timeout or a missing acknowledge,
+after I2C_RETRY_BACKOFF_US, doubled for every further attempt, and keeps its place in the queue.
+Only idempotent requests like "k?" should be queued with retries.
+
+The bus runs in standard mode, 100 kHz, or fast mode, 400 kHz, selectable at runtime by I2C_SetFrequency().
+Fast mode needs stronger pull ups than the internal ones, about 2.2 to 4.7 kOhm.
+After I2C_RECOVER_ERRORS failed transactions in a row the master frees the bus, see \link TwiMaster TWI Master Driver \endlink,
+and falls back to standard mode.
+It does so at once if the stop of a transfer never completes, a slave holding SCL low.
+The bus is freed at startup as well, a slave may still hold SDA low after a reset of the master in the middle of a read.
+
+The statistics compare the bus time used with the bus time of the padded frame reads
+and show per slave the round trip times, timeouts, retries and missing acknowledges,
+the bus speed in use, fallbacks to standard mode and bus recoveries.
+Per slave they count transactions, bytes out and in and requests refused as too long or because the queue was full.
+With I2C_TRACE set the last I2C_TRACE_SIZE transactions, retries included, are kept in a trace
+with start time, duration and the first I2C_TRACE_TEXT bytes of request and response.
+The trace takes about 220 bytes of SRAM, by default it is compiled for the native build only,
+for the Uno build with -D I2C_TRACE=1.
+Nothing is printed by the master itself, statistics and trace are printed on request only.
+
+On request the master records every completed transaction, after its last retry, as a binary record on a serial port,
+see I2C_SetRecorder(): the request, the response or the timeout and the response time, as I2C_Fetch() returns them.
+The host tool tools/i2c_capture.py writes the records to a log, the native build replays it with option -r,
+see I2C_SetReplay(): the results are fed to the controller at their recorded time instead of the bus,
+so an incident in the field is reproduced bit by bit and changes of the parser or the poll scheduler
+are measured against a real workload.
+The replay is compiled with I2C_REPLAY set only, by default not for AVR, it costs the firmware nothing.
+A record is only written if the transmit buffer has room for it, otherwise it is counted as dropped,
+a gap in the sequence numbers tells the host. Records longer than the transmit buffer are written when it is empty
+and wait for the rest, at 115200 Baud about 87 usec per byte.
+Record layout, all values little endian:
+<table border="0" width="80%">
+<tr><td> 0  </td><td> 2 </td><td> sync 0xA5 0xC3 </td></tr>
+<tr><td> 2  </td><td> 1 </td><td> length of the bytes 3 up to the end of the response </td></tr>
+<tr><td> 3  </td><td> 1 </td><td> version, I2C_RECORD_VERSION </td></tr>
+<tr><td> 4  </td><td> 1 </td><td> sequence number </td></tr>
+<tr><td> 5  </td><td> 4 </td><td> completion time, micros() </td></tr>
+<tr><td> 9  </td><td> 1 </td><td> slave number, bit 7 set for a slave without length prefix </td></tr>
+<tr><td> 10 </td><td> 1 </td><td> tag of the request </td></tr>
+<tr><td> 11 </td><td> 1 </td><td> result, response length or -3 </td></tr>
+<tr><td> 12 </td><td> 4 </td><td> response time in usec </td></tr>
+<tr><td> 16 </td><td> 1 </td><td> request length m </td></tr>
+<tr><td> 17 </td><td> m </td><td> request </td></tr>
+<tr><td> 17+m </td><td> n </td><td> response, n = result bytes </td></tr>
+<tr><td> end </td><td> 2 </td><td> CRC-16/CCITT-FALSE over bytes 2 up to the end of the response, as the telemetry frames </td></tr>
+</table>
+Recording starts with a state record, slave number 0, the general call address no request goes to.
+Its request holds the slaves without length prefix, 16 bytes with one bit per address,
+its response the state of the caller, e.g. the protocol and the values learned from the plant before the recording started.
+A replay takes this state just before the controller task which wrote it, so from there on the controller asks the same as in the field.
+
+<pre>
+(c)2015-2020 IngenieurbÃ¼ro Dr. Friedrich Haase
+             Consulting - Automatisierungstechnik
+</pre>
+
+<pre>
+<b>Versions</b>
+July 2015  Dr. Haase  created
+Sept 2015  Dr. Haase  converted for IT project
+Aug 2020   Dr. F. Haase  complete redesign
+</pre>
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+
+#ifndef I2C_REPLAY
+#if defined(__AVR__)
+//! replay switch, 1 compiles I2C_SetReplay() and I2C_Replay(), by default for the native build only
+#define I2C_REPLAY 0
+#else
+#define I2C_REPLAY 1
+#endif
+#endif
+
+#ifndef I2C_TRACE
+#if defined(__AVR__)
+//! trace switch, 1 compiles the trace of I2C_PrintTrace(), by default for the native build only
+#define I2C_TRACE 0
+#else
+#define I2C_TRACE 1
+#endif
+#endif
+
+                                                // I²C attributes
+//! max request and response length, size of a queue slot
+const int       I2C_DATA_MAX = 64;
+//! number of queue slots
+const int       I2C_QUEUE_SIZE = 3;
+//! max response length without length prefix, the padded frame formerly read with Wire
+const int       I2C_RESPONSE_MAX = 32;
+//! max bytes per read, the TWI receive buffer TWI_BUFFER_MAX
+const int       I2C_CHUNK_MAX = 32;
+//! header bit of a length prefix
+const uint8_t   I2C_LENGTH_FLAG = 0x80;
+//! max response length with length prefix
+const int       I2C_FRAMED_MAX = 127;
+//! time for the slave between request and response in usec
+const unsigned long I2C_RESPONSE_GAP_US = 1000;
+//! standard mode bus frequency in Hz
+const long      I2C_FREQUENCY_STANDARD = 100000L;
+//! fast mode bus frequency in Hz
+const long      I2C_FREQUENCY_FAST = 400000L;
+//! failed transactions in a row before the bus is freed and falls back to standard mode
+const uint8_t   I2C_RECOVER_ERRORS = 3;
+//! number of transactions kept in the trace
+const int       I2C_TRACE_SIZE = 8;
+//! bytes of request and response kept per trace entry
+const int       I2C_TRACE_TEXT = 8;
+//! number of slaves with their own round trip statistics, the last entry is shared by all further slaves
+const int       I2C_SLAVES_MAX = 2;
+//! min response timeout in usec
+const unsigned long I2C_TIMEOUT_MIN_US = 5000;
+//! max response timeout in usec, also the timeout of a slave not yet measured
+const unsigned long I2C_TIMEOUT_MAX_US = 100000;
+//! record layout version
+const uint8_t   I2C_RECORD_VERSION = 1;
+//! first sync byte of a record
+const uint8_t   I2C_RECORD_SYNC1 = 0xA5;
+//! second sync byte of a record, the telemetry frames use 0x5A
+const uint8_t   I2C_RECORD_SYNC2 = 0xC3;
+//! record bytes besides request and response, sync, length, header and CRC
+const int       I2C_RECORD_OVERHEAD = 2 + 1 + 14 + 2;
+//! time after which a replay expires a request without record in usec, longer than any request with its retries
+const unsigned long I2C_REPLAY_EXPIRE_US = 1000000UL;
+//! suggested retries of an idempotent request
+const uint8_t   I2C_RETRIES_MAX = 2;
+//! wait before the first retry in usec
+const unsigned long I2C_RETRY_BACKOFF_US = 2000;
+
+//! priority classes of requests, higher value wins
+enum I2C_Priority
+{
+  I2C_PRIO_POLL,                                ///< poll of plant values
+  I2C_PRIO_SETPOINT,                            ///< setpoint writes and manual commands
+  I2C_PRIO_SAFETY                               ///< safety writes, e.g. door open and drum stop
+};
+
+                                                // I²C prototypes
+//! I²C master setup
+/*!
+I²C master setup
+\param nFrequency I2C frequency
+*/
+extern void I2C_Master_Setup(long nFrequency);
+
+//! Select the bus speed
+/*!
+Select the bus speed, used from the next transaction on.
+\param nFrequency I2C_FREQUENCY_STANDARD or I2C_FREQUENCY_FAST
+*/
+extern void I2C_SetFrequency(long nFrequency);
+
+//! Bus speed in use
+/*!
+Bus speed in use, after a fallback I2C_FREQUENCY_STANDARD.
+\return frequency in Hz
+*/
+extern long I2C_Frequency();
+
+//! I²C master steady call
+/*!
+I²C master steady call, advances a transaction, never waits.
+To be called from loop() as often as possible.
+*/
+extern void I2C_Master_Steady();
+
+//! Queue a request
+/*!
+Queue a request to a slave.
+Expects a response.
+\param nSlaveNo target slave number for the request
+\param pszRequest request message
+\param nPriority see I2C_Priority
+\param nTag caller's tag, returned with the result
+\param nRetries repeats after a timeout, for idempotent requests only
+\return >=0 on success, -1 if the queue is full, -2 if too long
+*/
+extern int I2C_Queue(int nSlaveNo, const char * const pszRequest, uint8_t nPriority, uint8_t nTag, uint8_t nRetries = 0);
+
+//! Queue a binary request
+/*!
+Queue a binary request to a slave, e.g. a frame of the \link BinaryProtocol Binary Plant Protocol \endlink.
+Expects a response, which may be binary as well, I2C_Fetch() returns its length.
+\param nSlaveNo target slave number for the request
+\param pData request bytes
+\param nLength number of bytes
+\param nPriority see I2C_Priority
+\param nTag caller's tag, returned with the result
+\param nRetries repeats after a timeout, for idempotent requests only
+\return >=0 on success, -1 if the queue is full, -2 if too long
+*/
+extern int I2C_QueueData(int nSlaveNo, const uint8_t * pData, int nLength, uint8_t nPriority, uint8_t nTag, uint8_t nRetries = 0);
+
+//! Fetch the next result
+/*!
+Fetch the oldest result, a response or a timeout, and free its slot.
+A timeout is reported after the last retry.
+\param pnSlaveNo slave number the request was targeted
+\param pnTag storage for the tag of the request, may be nullptr
+\param pszResponse storage for received response, at least I2C_DATA_MAX+1 bytes
+\param pnResponseTime duration between queueing and completion in microseconds
+\returns >=0 length on success, -3 if timed out, -4 while no result is available
+*/
+extern int I2C_Fetch(int * pnSlaveNo, uint8_t * pnTag, char * pszResponse, unsigned long * pnResponseTime = nullptr);
+
+//! Number of requests of a priority class
+/*!
+Number of requests of a priority class queued or under way.
+\param nPriority see I2C_Priority
+\return number of requests
+*/
+extern int I2C_Queued(uint8_t nPriority);
+
+//! Send request to slave
+/*!
+Send request to slave, queues it as poll with tag 0.
+Expects a response.
+\param nSlaveNo target slave number for the request
+\param pszRequest request message
+\return >=0 on success, -1 if busy, -2 if too long
+*/
+extern int I2C_SendRequest(int nSlaveNo, const char * const pszRequest);
+
+//! Get text response for last request
+/*!
+Gets a received text response, the oldest result as I2C_Fetch() does.
+\param pnSlaveNo slave number the request was targeted
+\param pszResponse storage for received response
+\param pnResponseTime duration between request transmit start and response delivery in microseconds
+\returns >=0 length on success, -1 if busy, -3 if timed out, -4 while no outstanding response
+*/
+extern int I2C_GetResponse(int * pnSlaveNo, char * pszResponse, unsigned long * pnResponseTime = nullptr);
+
+//! See if ready for a request
+/*!
+See if there is a free slot for a request.
+\param nPriority see I2C_Priority
+\return true if I2C is ready
+*/
+extern bool I2C_IsReady(uint8_t nPriority = I2C_PRIO_POLL);
+
+//! See if request has been fulfilled
+/*!
+See if a result is available.
+\return true if a request got a reply or timed out
+*/
+extern bool I2C_HasReply();
+
+//! Max response length
+/*!
+Max response length of a slave, depends on whether it sends a length prefix.
+\param nSlaveNo slave number
+\return I2C_DATA_MAX with length prefix, otherwise I2C_RESPONSE_MAX
+*/
+extern int I2C_ResponseMax(int nSlaveNo);
+
+//! Response timeout of a slave
+/*!
+Response timeout of a slave derived from its round trip times.
+\param nSlaveNo slave number
+\return timeout in usec
+*/
+extern unsigned long I2C_Timeout(int nSlaveNo);
+
+//! Reset statistics
+/*!
+Reset transaction, bus time and per slave counters, the round trip estimates are kept.
+*/
+extern void I2C_ResetStats();
+
+//! Print statistics
+/*!
+Print transactions, bytes on the bus, max queue depth, requests refused because the queue was full,
+bus time per transaction in usec and the bus time the padded frame reads would have needed.
+Per slave transactions, bytes out and in, requests refused as too long or as busy.
+Bus speed, fallbacks, recoveries, recoveries which released SDA and which found the bus stuck.
+Per slave the smoothed, deviation and max round trip time and the timeout in usec,
+the number of timeouts, retries and missing acknowledges.
+\param out output stream, typically Serial
+*/
+extern void I2C_PrintStats(Print & out);
+
+//! Print the trace
+/*!
+Print the last transactions, oldest first, if compiled with I2C_TRACE:
+start time in msec, duration in usec, slave, request and response or timeout.
+Bytes which are not printable, e.g. of binary frames, are printed as \\xHH.
+\param out output stream, typically Serial
+*/
+extern void I2C_PrintTrace(Print & out);
+
+//! Record transactions
+/*!
+Record every completed transaction as binary record on a serial port, see \link I2C_Master I2C Master \endlink.
+Recording starts with a state record of what was learned before, the slaves without length prefix and the caller's state.
+\param pOut serial port, nullptr stops recording
+\param pState caller's state, e.g. the protocol of the plant, handed back by a replay
+\param nStateLength number of state bytes
+*/
+extern void I2C_SetRecorder(HardwareSerial * pOut, const uint8_t * pState = nullptr, uint8_t nStateLength = 0);
+
+//! Recorder counters
+/*!
+Records written and dropped because the transmit buffer was too full.
+\param pnDropped storage for the dropped records
+\return records written
+*/
+extern unsigned long I2C_Recorded(unsigned long * pnDropped);
+
+#if I2C_REPLAY
+//! Replay mode
+/*!
+In replay mode the master does not use the bus.
+Queued requests wait until I2C_Replay() completes them with a recorded result.
+Those without record end as timeout: at once if queued more than I2C_TIMEOUT_MAX_US before the first record,
+otherwise as soon as a request the master would have served later gets its result, at the latest after I2C_REPLAY_EXPIRE_US.
+\param bReplay true for replay mode
+\param usecStart time of the first record, micros()
+*/
+extern void I2C_SetReplay(bool bReplay, unsigned long usecStart = 0);
+
+//! Take a state record
+/*!
+Take the slaves without length prefix from a state record of the log.
+\param pLegacySlaves 16 bytes, one bit per address
+*/
+extern void I2C_ReplayState(const uint8_t * pLegacySlaves);
+
+//! Requests expired in replay mode
+/*!
+Queued requests the replay had no record for, ended as timeout.
+\return number of requests
+*/
+extern unsigned long I2C_ReplayExpired();
+
+//! Replay a recorded result
+/*!
+Complete the oldest queued request of the slave with the tag of the record,
+I2C_Fetch() returns the recorded result.
+If no such request is queued, the result takes a free slot.
+Queued requests the master would have served before the completed one have no record, they end as timeout,
+with a result not asked for those queued before its transaction started.
+The request is recorded as well, if recording, so the log of a replay can be compared with the original one.
+\param nSlaveNo slave number of the record
+\param bLegacySlave slave without length prefix, see I2C_ResponseMax()
+\param nTag tag of the record
+\param pRecorded recorded request
+\param nRecordedLength request length
+\param pResponse recorded response
+\param nResult recorded result, response length or -3
+\param nResponseTime recorded response time in usec
+\return 0 if the queued request equals the recorded one, 1 if it differs, 2 if none was queued, -1 if no slot is free
+*/
+extern int I2C_Replay(int nSlaveNo, bool bLegacySlave, uint8_t nTag, const uint8_t * pRecorded, int nRecordedLength,
+                      const uint8_t * pResponse, int nResult, unsigned long nResponseTime);
+#endif
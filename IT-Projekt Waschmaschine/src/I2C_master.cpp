@@ -1,167 +1,1085 @@
-/* I²C Master
-(c)2014..2020 Ingenieurbüro Dr. Friedrich Haase
-*/
-
-// include standard Arduino library
-#include <Arduino.h>
-// include standard I²C library
-#include <Wire.h>
-// include I²C master
-#include "I2C_Master.h"
-
-//! 16MHz CPU as for Arduino UNO and NANO
-static const long     CPU_FREQ = 16000000L;
-
-                                                // I²C communication data
-//! last used slave
-static int            nSlaveNoLast = 0;
-//! response storage
-static char           szResponse[I2C_DATA_MAX+1];
-//! response storage length
-static int            nResponseLength = 0;
-//! last request time in usec
-static unsigned long  nRequestTime = 0;
-//! response time in usec
-static unsigned long  nResponseTime = 0;
-//! response timeout in usec
-static unsigned long  nResponseTimeOut = 100000;
-
-//! state machine states
-enum I2C_State { I2C_READY, I2C_BUSY, I2C_DONE, I2C_TIMEOUT };
-//! current I2C state
-static I2C_State      nI2CState = I2C_READY;
-
-// I²C master setup
-void I2C_Master_Setup(long nFrequency)
-{
-  nI2CState = I2C_READY;
-  TWBR = ( CPU_FREQ / nFrequency - 16 ) / 2;    // set I²C speed
-//??  setClock(nFrequency);
-  Wire.begin();                                 // start I²C bus as master
-}
-
-// I²C master steady call
-void I2C_Master_Steady()
-{
-  switch ( nI2CState )
-  {
-  case I2C_READY:
-    // wait for a new job
-    break;
-  case I2C_BUSY:
-    if ( Wire.available() )
-    {
-      int   nReceived = 0;
-      char  ch;
-      while ( Wire.available() )
-      {
-        ch = Wire.read();                       // receive byte, typically I2C_DATA_MAX as requested
-        if ( nReceived < I2C_DATA_MAX )
-          szResponse[nReceived++] = ch;         // store received byte
-        // else forget it
-      }
-      szResponse[nReceived] = 0;                // make sure there is a trailing 0
-      nResponseLength = nReceived;
-      nResponseTime = micros() - nRequestTime;
-      nI2CState = I2C_DONE;                     // received complete, expect user fetches response
-    }
-    else if ( ( micros() - nRequestTime ) >= nResponseTimeOut )
-    {                                           // timeout
-      nResponseTime = micros() - nRequestTime;  //?? required
-      nI2CState = I2C_TIMEOUT;
-    }
-    break;
-  case I2C_DONE:
-    // remain here until response has been delivered
-    break;
-  case I2C_TIMEOUT:
-    // remain here until response has been asked
-    break;
-  }
-  delay(1);
-}
-
-// Send request to slave
-int I2C_SendRequest(int nSlaveNo, const char * const pszRequest)
-{
-  if ( nI2CState != I2C_READY )
-    return -1;                                  // fail if not ready
-
-  int  nLength = strlen(pszRequest);            // message length
-  if ( nLength > I2C_DATA_MAX )
-    return -2;                                  // fail, too long
-  
-  nI2CState = I2C_BUSY;                         // busy now
-  nSlaveNoLast = nSlaveNo;
-  nRequestTime = micros();
-  Wire.beginTransmission(nSlaveNo);             // transmit to slave device
-  Wire.write(pszRequest, nLength);              // send data
-  Wire.endTransmission();                       // ends transmitting
-
-  delay(1);
-  Wire.requestFrom(nSlaveNo, I2C_DATA_MAX);     // request from slave
-
-  return nLength;                               // request done
-}
-
-// Get text response for last request
-int I2C_GetResponse(int * pnSlaveNo, char * pszResponse, unsigned long * pnResponseTime /*=nullptr*/)
-{
-  switch ( nI2CState )
-  {
-  case I2C_BUSY:
-    return -1;                                  // fail if busy
-  case I2C_READY:
-    return -4;                                  // fail if no outstanding response
-  case I2C_TIMEOUT:
-    *pszResponse = 0;
-    *pnSlaveNo = nSlaveNoLast;
-    if ( pnResponseTime != nullptr )
-      *pnResponseTime = nResponseTimeOut;
-    nI2CState = I2C_READY;
-    return -3;                                  // fail if timed out
-  case I2C_DONE:
-    strcpy(pszResponse, szResponse);            // return received answer
-    *pnSlaveNo = nSlaveNoLast;
-    if ( pnResponseTime != nullptr )
-      *pnResponseTime = nResponseTime;
-    nI2CState = I2C_READY;
-    return nResponseLength;
-  }
-  return -1;                                    // should not happen, fail
-}
-
-// See if ready for a request
-bool I2C_IsReady()
-{
-  return nI2CState == I2C_READY;
-}
-
-// See if request has been fulfilled
-bool I2C_HasReply()
-{
-  return ( nI2CState == I2C_DONE ) || ( nI2CState == I2C_TIMEOUT );
-}
-
-// not used so far, possibly not required
-#if 0
-//! See if request in progress
-/*!
-See if request in progress.
-\return true if I2C is busy on a previous command
-*/
-bool I2C_IsBusy()
-{
-  return nI2CState == I2C_BUSY;
-}
-
-//! See if request timed out
-/*!
-See if request timed out.
-\return true if I2C previous command got no reply in due time
-*/
-bool I2C_HasTimeout()
-{
-  return nI2CState == I2C_TIMEOUT;
-}
-#endif
+/* I²C Master
+(c)2014..2020 Ingenieurbüro Dr. Friedrich Haase
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include I²C master
+#include "I2C_Master.h"
+// include TWI master driver
+#include "TwiMaster.h"
+
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64                // transmit buffer of HardwareSerial
+#endif
+
+//! slot states
+enum I2C_SlotState { I2C_SLOT_FREE, I2C_SLOT_QUEUED, I2C_SLOT_ACTIVE, I2C_SLOT_DONE, I2C_SLOT_TIMEOUT };
+
+//! request queue slot
+struct I2C_Slot
+{
+  uint8_t       nState;                         ///< see I2C_SlotState
+  uint8_t       nSlaveNo;                       ///< target slave
+  uint8_t       nPriority;                      ///< see I2C_Priority
+  uint8_t       nTag;                           ///< caller's tag, returned with the response
+  unsigned long nSequence;                      ///< order of queueing, then of completion
+  int           nLength;                        ///< request, then response length
+  unsigned long nResponseTime;                  ///< duration from queueing to completion in usec
+  uint8_t       nRetries;                       ///< retries left
+  uint8_t       nAttempts;                      ///< attempts so far
+  unsigned long usecRetry;                      ///< earliest start of the next attempt
+#if I2C_REPLAY
+  unsigned long usecQueued;                     ///< time of queueing, a replay expires requests without record
+#endif
+  char          szText[I2C_DATA_MAX+1];         ///< request, then response
+};
+
+//! round trip statistics of a slave
+struct I2C_SlaveStats
+{
+  uint8_t       nSlaveNo;                       ///< slave number, 0 for an unused entry
+  uint8_t       nBackoff;                       ///< timeout doublings since the last response
+  long          usecRttAvg;                     ///< smoothed round trip time, 0 while not measured
+  long          usecRttDev;                     ///< smoothed mean deviation of the round trip time
+  unsigned long usecRttMax;                     ///< max round trip time
+  unsigned long nTimeouts;                      ///< number of timeouts
+  unsigned long nRetries;                       ///< number of repeated requests
+  unsigned long nNacks;                         ///< number of missing acknowledges and bus errors
+  unsigned long nTransactions;                  ///< number of transactions, retries included
+  unsigned long nBytesOut;                      ///< request bytes sent
+  unsigned long nBytesIn;                       ///< response bytes received
+  unsigned int  nTooLong;                       ///< requests refused as too long
+  unsigned int  nBusy;                          ///< requests refused because the queue was full
+};
+
+#if I2C_TRACE
+//! trace entry of a transaction
+struct I2C_TraceEntry
+{
+  unsigned long msecStart;                      ///< start time
+  unsigned long usecDuration;                   ///< duration
+  uint8_t       nSlaveNo;                       ///< target slave
+  int8_t        nResult;                        ///< response length, -3 on failure
+  uint8_t       nRequestLength;                 ///< request length
+  char          Request[I2C_TRACE_TEXT];        ///< start of the request
+  char          Response[I2C_TRACE_TEXT];       ///< start of the response
+};
+#endif
+
+                                                // I²C communication data
+//! request queue
+static I2C_Slot       Slots[I2C_QUEUE_SIZE];
+//! slot of the transaction under way, -1 if none
+static int            nActive = -1;
+//! sequence counter
+static unsigned long  nSequenceNext = 0;
+//! transaction start time in usec
+static unsigned long  nRequestTime = 0;
+//! response timeout of the transaction under way in usec
+static unsigned long  nResponseTimeOut = I2C_TIMEOUT_MAX_US;
+//! request of the transaction under way, the slot takes the response
+static uint8_t        Request[I2C_DATA_MAX];
+//! length of the request under way
+static int            nRequestLength = 0;
+//! round trip statistics, the last entry is shared by all further slaves
+static I2C_SlaveStats SlaveStats[I2C_SLAVES_MAX];
+//! slaves without length prefix, one bit per address
+static uint8_t        LegacySlaves[16];
+//! I²C frequency in Hz in use
+static long           nBusFrequency = I2C_FREQUENCY_STANDARD;
+//! I²C frequency in Hz to be used from the next transaction on
+static long           nNextFrequency = I2C_FREQUENCY_STANDARD;
+//! failed transactions in a row
+static uint8_t        nErrorsInRow = 0;
+
+                                                // I²C statistics
+//! number of transactions
+static unsigned long  nTransactions = 0;
+//! payload bytes on the bus, requests and responses
+static unsigned long  nBusBytes = 0;
+//! bits clocked on the bus, including addresses, acknowledges, start and stop
+static unsigned long  nBusBits = 0;
+//! bits the padded frame reads would have clocked
+static unsigned long  nLegacyBits = 0;
+//! requests refused because the queue was full
+static unsigned long  nQueueFull = 0;
+//! max number of slots in use
+static uint8_t        nQueueDepthMax = 0;
+//! number of bus recoveries
+static unsigned long  nRecoveries = 0;
+//! recoveries which found SDA held low and released it
+static unsigned long  nReleased = 0;
+//! recoveries which could not free the bus
+static unsigned long  nStuck = 0;
+//! fallbacks from fast to standard mode
+static unsigned long  nFallbacks = 0;
+#if I2C_TRACE
+//! trace of the last transactions, circular
+static I2C_TraceEntry Trace[I2C_TRACE_SIZE];
+//! next trace entry to write
+static uint8_t        nTraceNext = 0;
+//! number of trace entries written, up to I2C_TRACE_SIZE
+static uint8_t        nTraceCount = 0;
+#endif
+//! serial port of the recorder, nullptr if off
+static HardwareSerial * pRecorder = nullptr;
+//! sequence number of the next record
+static uint8_t        nRecordSequence = 0;
+//! records written
+static unsigned long  nRecords = 0;
+//! records dropped, transmit buffer too full
+static unsigned long  nRecordsDropped = 0;
+//! CRC of the record being written
+static uint16_t       nRecordCrc = 0;
+#if I2C_REPLAY
+//! replay mode, results come from I2C_Replay()
+static bool           bReplay = false;
+//! requests expired in replay mode, no record for them
+static unsigned long  nReplayExpired = 0;
+//! time of the first record of the replay in usec
+static unsigned long  usecReplayStart = 0;
+#endif
+
+//! steps of the transaction under way
+enum I2C_Step { I2C_STEP_WRITE, I2C_STEP_GAP, I2C_STEP_HEADER, I2C_STEP_PAYLOAD, I2C_STEP_PADDED };
+//! current step
+static I2C_Step       nI2CStep = I2C_STEP_WRITE;
+//! response length announced by the header
+static int            nExpectedLength = 0;
+//! start of the gap in usec
+static unsigned long  usecGapStart = 0;
+
+//! See if a slave sends no length prefix
+static bool IsLegacy(uint8_t nSlaveNo)
+{
+  return LegacySlaves[( nSlaveNo >> 3 ) & 0x0F] & ( 1 << ( nSlaveNo & 7 ) );
+}
+
+//! Round trip statistics of a slave
+/*!
+Find the round trip statistics of a slave, take a new entry for an unknown slave.
+\param nSlaveNo slave number
+\return statistics entry
+*/
+static I2C_SlaveStats & FindSlave(uint8_t nSlaveNo)
+{
+  int   i;
+  for ( i = 0; i < I2C_SLAVES_MAX - 1; ++i )
+  {
+    if ( SlaveStats[i].nSlaveNo == nSlaveNo )
+      break;
+    if ( SlaveStats[i].nSlaveNo == 0 )
+    {
+      SlaveStats[i].nSlaveNo = nSlaveNo;        // new slave
+      break;
+    }
+  }
+  if ( SlaveStats[i].nSlaveNo == 0 )
+    SlaveStats[i].nSlaveNo = nSlaveNo;          // shared entry, named after its first slave
+  return SlaveStats[i];
+}
+
+//! Take a round trip time
+/*!
+Take the round trip time of a successful transaction into the smoothed values,
+gain 1/8 for the average and 1/4 for the deviation.
+\param stats statistics of the slave
+\param usecRtt round trip time
+*/
+static void TakeRoundTrip(I2C_SlaveStats & stats, unsigned long usecRtt)
+{
+  if ( stats.usecRttAvg == 0 )
+  {                                             // first measurement
+    stats.usecRttAvg = usecRtt;
+    stats.usecRttDev = usecRtt / 2;
+  }
+  else
+  {
+    long  usecDiff = (long)usecRtt - stats.usecRttAvg;
+    stats.usecRttAvg += usecDiff / 8;
+    stats.usecRttDev += ( labs(usecDiff) - stats.usecRttDev ) / 4;
+  }
+  if ( usecRtt > stats.usecRttMax )
+    stats.usecRttMax = usecRtt;
+  stats.nBackoff = 0;
+}
+
+//! Free the bus
+/*!
+Free a bus possibly hung by a slave.
+\param bFallback fall back to standard mode
+*/
+static void RecoverBus(bool bFallback)
+{
+  ++nRecoveries;
+  switch ( Twi_Recover() )
+  {
+  case TWI_BUS_RELEASED:
+    ++nReleased;
+    break;
+  case TWI_BUS_STUCK:
+    ++nStuck;
+    break;
+  }
+  if ( bFallback && ( nNextFrequency > I2C_FREQUENCY_STANDARD ) )
+  {                                             // fast mode fails, e.g. weak pull ups
+    nNextFrequency = I2C_FREQUENCY_STANDARD;
+    ++nFallbacks;
+  }
+  nErrorsInRow = 0;
+}
+
+//! Count a failed transaction
+/*!
+Count a failed transaction, recover the bus after I2C_RECOVER_ERRORS in a row.
+*/
+static void CountError()
+{
+  if ( ++nErrorsInRow >= I2C_RECOVER_ERRORS )
+    RecoverBus(true);
+}
+
+// I²C master setup
+void I2C_Master_Setup(long nFrequency)
+{
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+    Slots[i].nState = I2C_SLOT_FREE;
+  nActive = -1;
+  memset(LegacySlaves, 0, sizeof(LegacySlaves)); // try length prefixed responses first
+  nBusFrequency = nFrequency;
+  nNextFrequency = nFrequency;
+  Twi_Setup(nFrequency);                        // start I²C bus as master
+  RecoverBus(false);                            // slave possibly hung by a reset of the master
+}
+
+//! Bits clocked for a transfer
+/*!
+Bits clocked for one transfer: start, address, data bytes with acknowledge each, stop.
+\param nBytes data bytes
+\return bits
+*/
+static unsigned long TransferBits(int nBytes)
+{
+  return 1 + 9 + 9UL * nBytes + 1;
+}
+
+//! Start reading the response
+/*!
+Start reading the response, the length prefix or a padded frame.
+*/
+static void StartResponse()
+{
+  I2C_Slot & slot = Slots[nActive];
+  if ( IsLegacy(slot.nSlaveNo) )
+  {
+    nI2CStep = I2C_STEP_PADDED;
+    nBusBits += TransferBits(I2C_RESPONSE_MAX);
+    Twi_Start(slot.nSlaveNo, nullptr, 0, I2C_RESPONSE_MAX);
+  }
+  else
+  {
+    nI2CStep = I2C_STEP_HEADER;
+    nBusBits += TransferBits(1);
+    Twi_Start(slot.nSlaveNo, nullptr, 0, 1);
+  }
+}
+
+//! Start reading the next payload chunk
+static void StartChunk()
+{
+  I2C_Slot & slot = Slots[nActive];
+  int   nChunk = min(nExpectedLength - slot.nLength, I2C_CHUNK_MAX);
+  nBusBits += TransferBits(nChunk);
+  Twi_Start(slot.nSlaveNo, nullptr, 0, nChunk);
+}
+
+#if I2C_TRACE
+//! Trace a transaction
+/*!
+Keep the transaction under way in the trace, overwrites the oldest entry.
+\param slot slot of the transaction, holds the response
+\param nResult response length, -3 on failure
+*/
+static void TraceTransaction(const I2C_Slot & slot, int nResult)
+{
+  I2C_TraceEntry & entry = Trace[nTraceNext];
+  entry.msecStart = millis() - ( micros() - nRequestTime ) / 1000;
+  entry.usecDuration = micros() - nRequestTime;
+  entry.nSlaveNo = slot.nSlaveNo;
+  entry.nResult = nResult;
+  entry.nRequestLength = nRequestLength;
+  memcpy(entry.Request, Request, min(nRequestLength, I2C_TRACE_TEXT));
+  if ( nResult > 0 )
+    memcpy(entry.Response, slot.szText, min(nResult, I2C_TRACE_TEXT));
+  nTraceNext = ( nTraceNext + 1 ) % I2C_TRACE_SIZE;
+  if ( nTraceCount < I2C_TRACE_SIZE )
+    ++nTraceCount;
+}
+
+//! Print trace bytes
+/*!
+Print bytes of a trace entry, printable characters as they are, others as \\xHH.
+\param out output stream
+\param pData bytes
+\param nLength number of bytes, at most I2C_TRACE_TEXT are kept
+*/
+static void PrintTraceBytes(Print & out, const char * pData, int nLength)
+{
+  for ( int i = 0; i < min(nLength, I2C_TRACE_TEXT); ++i )
+  {
+    uint8_t ch = pData[i];
+    if ( ( ch >= ' ' ) && ( ch < 0x7F ) )
+      out.print((char)ch);
+    else
+    {
+      out.print(F("\\x"));
+      if ( ch < 0x10 )
+        out.print('0');
+      out.print(ch, HEX);
+    }
+  }
+  if ( nLength > I2C_TRACE_TEXT )
+    out.print(F(".."));
+}
+#else
+//! Trace a transaction, nothing is kept without I2C_TRACE
+static inline void TraceTransaction(const I2C_Slot &, int) { }
+#endif
+
+//! Update a CRC-16/CCITT-FALSE with one byte, as the telemetry frames
+static uint16_t Crc16Update(uint16_t nCrc, uint8_t nByte)
+{
+  nCrc ^= (uint16_t)nByte << 8;
+  for ( int i = 0; i < 8; ++i )
+    nCrc = ( nCrc & 0x8000 ) ? ( nCrc << 1 ) ^ 0x1021 : ( nCrc << 1 );
+  return nCrc;
+}
+
+//! Write record bytes
+/*!
+Write bytes of a record and take them into its CRC.
+\param pData bytes
+\param nLength number of bytes
+*/
+static void RecordBytes(const void * pData, int nLength)
+{
+  const uint8_t * p = (const uint8_t *)pData;
+  for ( int i = 0; i < nLength; ++i )
+    nRecordCrc = Crc16Update(nRecordCrc, p[i]);
+  pRecorder->write(p, nLength);
+}
+
+//! Write a record value
+/*!
+Write a value of a record little endian.
+\param nValue value
+\param nBytes value size in bytes
+*/
+static void RecordValue(unsigned long nValue, int nBytes)
+{
+  uint8_t       Value[4];
+  for ( int i = 0; i < nBytes; ++i )
+  {
+    Value[i] = nValue & 0xFF;
+    nValue >>= 8;
+  }
+  RecordBytes(Value, nBytes);
+}
+
+//! Write a record
+/*!
+Write a record, see \link I2C_Master I2C Master \endlink, if the transmit buffer has room for it.
+\param nSlaveNo slave number, bit 7 set for a slave without length prefix, 0 for a state record
+\param nTag tag of the request
+\param nResult response length, -3 on failure
+\param nResponseTime response time in usec
+\param pRequest request bytes
+\param nRequestLength request length
+\param pResponse response bytes, max(nResult, 0) of them
+*/
+static void WriteRecord(uint8_t nSlaveNo, uint8_t nTag, int nResult, unsigned long nResponseTime,
+                        const void * pRequest, int nRequestLength, const void * pResponse)
+{
+  int   nResponseLength = max(nResult, 0);
+  int   nSize = I2C_RECORD_OVERHEAD + nRequestLength + nResponseLength;
+  int   nFree = pRecorder->availableForWrite();
+  if ( ( nFree < nSize ) && ( ( nFree < SERIAL_TX_BUFFER_SIZE - 1 ) || ( nSize < SERIAL_TX_BUFFER_SIZE ) ) )
+  {                                             // would block, unless a long record waits for an empty buffer
+    ++nRecordsDropped;
+    ++nRecordSequence;                          // the gap tells the host
+    return;
+  }
+  uint8_t       Sync[2] = { I2C_RECORD_SYNC1, I2C_RECORD_SYNC2 };
+  pRecorder->write(Sync, sizeof(Sync));
+  nRecordCrc = 0xFFFF;
+  RecordValue(nSize - 2 - 1 - 2, 1);
+  RecordValue(I2C_RECORD_VERSION, 1);
+  RecordValue(nRecordSequence++, 1);
+  RecordValue(micros(), 4);
+  RecordValue(nSlaveNo, 1);
+  RecordValue(nTag, 1);
+  RecordValue((uint8_t)nResult, 1);
+  RecordValue(nResponseTime, 4);
+  RecordValue(nRequestLength, 1);
+  RecordBytes(pRequest, nRequestLength);
+  RecordBytes(pResponse, nResponseLength);
+  RecordValue(nRecordCrc, 2);
+  ++nRecords;
+}
+
+//! Record a transaction
+/*!
+Record the transaction under way, see \link I2C_Master I2C Master \endlink.
+The request is taken from Request, the result from the slot.
+\param slot slot of the transaction, holds the response
+\param nResult response length, -3 on failure
+*/
+static void RecordTransaction(const I2C_Slot & slot, int nResult)
+{
+  if ( pRecorder == nullptr )
+    return;
+  WriteRecord(slot.nSlaveNo | ( IsLegacy(slot.nSlaveNo) ? 0x80 : 0 ), slot.nTag, nResult, slot.nResponseTime,
+              Request, nRequestLength, slot.szText);
+}
+
+//! End the transaction under way
+/*!
+End the transaction under way, the slot keeps the result until it is fetched.
+A failed request with retries left is queued again instead.
+\param nState I2C_SLOT_DONE or I2C_SLOT_TIMEOUT
+*/
+static void EndTransaction(uint8_t nState)
+{
+  I2C_Slot & slot = Slots[nActive];
+  I2C_SlaveStats & stats = FindSlave(slot.nSlaveNo);
+  if ( nState == I2C_SLOT_DONE )
+  {
+    slot.szText[slot.nLength] = 0;              // make sure there is a trailing 0
+    TakeRoundTrip(stats, micros() - nRequestTime);
+    stats.nBytesIn += slot.nLength;
+    TraceTransaction(slot, slot.nLength);
+    nErrorsInRow = 0;
+  }
+  else
+  {
+    TraceTransaction(slot, -3);
+    if ( slot.nRetries > 0 )
+    {                                           // try again after a backoff, keeps its place in the queue
+      --slot.nRetries;
+      ++stats.nRetries;
+      slot.usecRetry = micros() + ( I2C_RETRY_BACKOFF_US << ( slot.nAttempts - 1 ) );
+      memcpy(slot.szText, Request, nRequestLength);
+      slot.nLength = nRequestLength;
+      slot.nState = I2C_SLOT_QUEUED;
+      nActive = -1;
+      return;
+    }
+    slot.szText[0] = 0;
+    slot.nLength = 0;
+  }
+  slot.nResponseTime = micros() - nRequestTime;
+  slot.nSequence = nSequenceNext++;             // results are fetched in order of completion
+  slot.nState = nState;
+  RecordTransaction(slot, ( nState == I2C_SLOT_DONE ) ? slot.nLength : -3);
+  nActive = -1;
+}
+
+#if I2C_REPLAY
+//! Expire a request without record
+/*!
+End a queued request as timeout in replay mode, it is not recorded.
+\param slot slot of the request
+*/
+static void ExpireRequest(I2C_Slot & slot)
+{
+  slot.nLength = 0;
+  slot.szText[0] = 0;
+  slot.nResponseTime = micros() - slot.usecQueued;
+  slot.nSequence = nSequenceNext++;             // fetched in order of completion
+  slot.nState = I2C_SLOT_TIMEOUT;
+  ++nReplayExpired;
+}
+
+//! Expire requests without record
+/*!
+In replay mode a queued request the log holds no result for would wait forever and clog the queue.
+A request queued more than I2C_TIMEOUT_MAX_US before the first record has been done before the recording started,
+it ends as timeout at once, so typed commands get through in time as in the field.
+Any other ends as timeout after I2C_REPLAY_EXPIRE_US.
+*/
+static void ExpireUnrecorded()
+{
+  unsigned long usecNow = micros();
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+  {
+    if ( Slots[i].nState != I2C_SLOT_QUEUED )
+      continue;
+    if (   ( (long)( usecReplayStart - Slots[i].usecQueued ) > (long)I2C_TIMEOUT_MAX_US )
+        || ( usecNow - Slots[i].usecQueued >= I2C_REPLAY_EXPIRE_US ) )
+      ExpireRequest(Slots[i]);
+  }
+}
+#endif
+
+//! Start the next queued transaction
+/*!
+Start the queued request with the highest priority, the oldest first.
+*/
+static void StartTransaction()
+{
+#if I2C_REPLAY
+  if ( bReplay )
+    return;                                     // results come from I2C_Replay()
+#endif
+  int   nBest = -1;
+  unsigned long usecNow = micros();
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+  {
+    if ( Slots[i].nState != I2C_SLOT_QUEUED )
+      continue;
+    if ( ( Slots[i].nAttempts > 0 ) && ( (long)( usecNow - Slots[i].usecRetry ) < 0 ) )
+      continue;                                 // retry not yet due
+    if (   ( nBest < 0 )
+        || ( Slots[i].nPriority > Slots[nBest].nPriority )
+        || (   ( Slots[i].nPriority == Slots[nBest].nPriority )
+            && ( (long)( Slots[i].nSequence - Slots[nBest].nSequence ) < 0 ) ) )
+      nBest = i;
+  }
+  if ( nBest < 0 )
+    return;                                     // nothing to do
+
+  if ( nNextFrequency != nBusFrequency )
+  {                                             // new bus speed, between transfers only
+    nBusFrequency = nNextFrequency;
+    Twi_SetFrequency(nBusFrequency);
+    for ( int i = 0; i < I2C_SLAVES_MAX; ++i )
+    {                                           // round trip times change with the speed
+      SlaveStats[i].usecRttAvg = 0;
+      SlaveStats[i].nBackoff = 0;
+    }
+  }
+
+  nActive = nBest;
+  I2C_Slot & slot = Slots[nActive];
+  slot.nState = I2C_SLOT_ACTIVE;
+  ++slot.nAttempts;
+  memcpy(Request, slot.szText, slot.nLength);   // the interrupt sends from here, the slot takes the response
+  nRequestLength = slot.nLength;
+  I2C_SlaveStats & stats = FindSlave(slot.nSlaveNo);
+  ++stats.nTransactions;
+  stats.nBytesOut += slot.nLength;
+  nI2CStep = I2C_STEP_WRITE;
+  nResponseTimeOut = I2C_Timeout(slot.nSlaveNo);
+  nRequestTime = micros();
+  ++nTransactions;
+  nBusBytes += slot.nLength;
+  nBusBits += TransferBits(slot.nLength);
+  nLegacyBits += TransferBits(slot.nLength) + TransferBits(I2C_RESPONSE_MAX);
+  if ( I2C_RESPONSE_GAP_US == 0 )
+  {                                             // request, repeated start and response in one transfer
+    bool  bLegacy = IsLegacy(slot.nSlaveNo);
+    int   nRead = bLegacy ? I2C_RESPONSE_MAX : 1;
+    nI2CStep = bLegacy ? I2C_STEP_PADDED : I2C_STEP_HEADER;
+    nBusBits += TransferBits(nRead) - 1;        // no stop and start in between
+    Twi_Start(slot.nSlaveNo, Request, slot.nLength, nRead);
+  }
+  else
+    Twi_Start(slot.nSlaveNo, Request, slot.nLength, 0); // the interrupt does the rest
+}
+
+//! Advance a transaction after a completed transfer
+/*!
+Advance a transaction after a completed transfer, never waits.
+Reads the length prefix, then the payload in chunks, or a padded frame if the slave sends no length prefix.
+The response replaces the request in the slot.
+*/
+static void AdvanceTransaction()
+{
+  I2C_Slot &      slot = Slots[nActive];
+  int             nReceived;
+  const uint8_t * pData = Twi_Data(&nReceived);
+
+  switch ( nI2CStep )
+  {
+  case I2C_STEP_WRITE:
+    nI2CStep = I2C_STEP_GAP;                    // give the slave time to prepare its response
+    usecGapStart = micros();
+    break;
+  case I2C_STEP_GAP:
+    if ( ( micros() - usecGapStart ) >= I2C_RESPONSE_GAP_US )
+      StartResponse();
+    break;
+  case I2C_STEP_HEADER:
+    if ( pData[0] & I2C_LENGTH_FLAG )
+    {
+      nBusBytes += 1;
+      nExpectedLength = pData[0] & ~I2C_LENGTH_FLAG;
+      if ( nExpectedLength > I2C_DATA_MAX )
+        nExpectedLength = I2C_DATA_MAX;         // rest is dropped with the chunks not read
+      slot.nLength = 0;
+      nI2CStep = I2C_STEP_PAYLOAD;
+      if ( nExpectedLength == 0 )
+        EndTransaction(I2C_SLOT_DONE);
+      else
+        StartChunk();
+    }
+    else
+    {                                           // ASCII, slave without length prefix
+      LegacySlaves[( slot.nSlaveNo >> 3 ) & 0x0F] |= 1 << ( slot.nSlaveNo & 7 );
+      StartResponse();
+    }
+    break;
+  case I2C_STEP_PAYLOAD:
+    for ( int i = 0; ( i < nReceived ) && ( slot.nLength < nExpectedLength ); ++i )
+      slot.szText[slot.nLength++] = pData[i];
+    nBusBytes += nReceived;
+    if ( slot.nLength < nExpectedLength )
+      StartChunk();
+    else
+      EndTransaction(I2C_SLOT_DONE);
+    break;
+  case I2C_STEP_PADDED:
+    nReceived = min(nReceived, I2C_DATA_MAX);
+    memcpy(slot.szText, pData, nReceived);
+    nBusBytes += nReceived;
+    slot.szText[nReceived] = 0;
+    slot.nLength = strlen(slot.szText);         // text up to the first 0
+    EndTransaction(I2C_SLOT_DONE);
+    break;
+  }
+}
+
+// I²C master steady call
+void I2C_Master_Steady()
+{
+#if I2C_REPLAY
+  if ( bReplay )
+  {                                             // no bus
+    ExpireUnrecorded();
+    return;
+  }
+#endif
+  if ( nActive < 0 )
+  {
+    StartTransaction();                         // next request, if any
+    return;
+  }
+
+  if ( ( micros() - nRequestTime ) >= nResponseTimeOut )
+  {                                             // timeout
+    if ( Twi_Status() == TWI_BUSY )
+      Twi_Abort();                              // release the bus
+    I2C_SlaveStats & stats = FindSlave(Slots[nActive].nSlaveNo);
+    ++stats.nTimeouts;
+    if ( ( I2C_TIMEOUT_MIN_US << stats.nBackoff ) < I2C_TIMEOUT_MAX_US )
+      ++stats.nBackoff;                         // allow more time until the next response
+    EndTransaction(I2C_SLOT_TIMEOUT);
+    CountError();
+    return;
+  }
+  switch ( Twi_Status() )
+  {
+  case TWI_BUSY:
+    break;                                      // transfer under way
+  case TWI_OK:
+    AdvanceTransaction();
+    break;
+  case TWI_STUCK:                               // stop never completed, no use to wait for more errors
+    ++FindSlave(Slots[nActive].nSlaveNo).nNacks;
+    EndTransaction(I2C_SLOT_TIMEOUT);
+    RecoverBus(true);
+    break;
+  default:                                      // no acknowledge or bus error, no response
+    ++FindSlave(Slots[nActive].nSlaveNo).nNacks;
+    EndTransaction(I2C_SLOT_TIMEOUT);
+    CountError();
+    break;
+  }
+}
+
+// Queue a request
+int I2C_Queue(int nSlaveNo, const char * const pszRequest, uint8_t nPriority, uint8_t nTag, uint8_t nRetries /*=0*/)
+{
+  return I2C_QueueData(nSlaveNo, (const uint8_t *)pszRequest, strlen(pszRequest), nPriority, nTag, nRetries);
+}
+
+// Queue a binary request
+int I2C_QueueData(int nSlaveNo, const uint8_t * pData, int nLength, uint8_t nPriority, uint8_t nTag, uint8_t nRetries /*=0*/)
+{
+  if ( nLength > I2C_DATA_MAX )
+  {
+    ++FindSlave(nSlaveNo).nTooLong;
+    return -2;                                  // fail, too long
+  }
+  if ( ! I2C_IsReady(nPriority) )
+  {
+    ++nQueueFull;
+    ++FindSlave(nSlaveNo).nBusy;
+    return -1;                                  // fail, queue full
+  }
+
+  int   nUsed = 1;
+  int   nFree = -1;
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+    if ( Slots[i].nState != I2C_SLOT_FREE )
+      ++nUsed;
+    else if ( nFree < 0 )
+      nFree = i;
+  if ( nUsed > nQueueDepthMax )
+    nQueueDepthMax = nUsed;
+
+  I2C_Slot & slot = Slots[nFree];
+  memcpy(slot.szText, pData, nLength);          // keep it while the interrupt sends it
+  slot.nLength = nLength;
+  slot.nSlaveNo = nSlaveNo;
+  slot.nPriority = nPriority;
+  slot.nTag = nTag;
+  slot.nRetries = nRetries;
+  slot.nAttempts = 0;
+  slot.nSequence = nSequenceNext++;
+#if I2C_REPLAY
+  slot.usecQueued = micros();
+#endif
+  slot.nState = I2C_SLOT_QUEUED;
+  if ( nActive < 0 )
+    StartTransaction();                         // bus idle, start at once
+  return nLength;                               // request queued
+}
+
+// Fetch the next result
+int I2C_Fetch(int * pnSlaveNo, uint8_t * pnTag, char * pszResponse, unsigned long * pnResponseTime /*=nullptr*/)
+{
+  int   nOldest = -1;
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+  {
+    if ( ( Slots[i].nState != I2C_SLOT_DONE ) && ( Slots[i].nState != I2C_SLOT_TIMEOUT ) )
+      continue;
+    if ( ( nOldest < 0 ) || ( (long)( Slots[i].nSequence - Slots[nOldest].nSequence ) < 0 ) )
+      nOldest = i;
+  }
+  if ( nOldest < 0 )
+    return -4;                                  // nothing complete
+
+  I2C_Slot & slot = Slots[nOldest];
+  memcpy(pszResponse, slot.szText, slot.nLength + 1); // return received answer with its trailing 0
+  *pnSlaveNo = slot.nSlaveNo;
+  if ( pnTag != nullptr )
+    *pnTag = slot.nTag;
+  if ( pnResponseTime != nullptr )
+    *pnResponseTime = slot.nResponseTime;
+  int   nResult = ( slot.nState == I2C_SLOT_DONE ) ? slot.nLength : -3;
+  slot.nState = I2C_SLOT_FREE;
+  return nResult;
+}
+
+// Number of requests of a priority class
+int I2C_Queued(uint8_t nPriority)
+{
+  int   nCount = 0;
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+    if (   ( ( Slots[i].nState == I2C_SLOT_QUEUED ) || ( Slots[i].nState == I2C_SLOT_ACTIVE ) )
+        && ( Slots[i].nPriority == nPriority ) )
+      ++nCount;
+  return nCount;
+}
+
+// Send request to slave
+int I2C_SendRequest(int nSlaveNo, const char * const pszRequest)
+{
+  return I2C_Queue(nSlaveNo, pszRequest, I2C_PRIO_POLL, 0);
+}
+
+// Get text response for last request
+int I2C_GetResponse(int * pnSlaveNo, char * pszResponse, unsigned long * pnResponseTime /*=nullptr*/)
+{
+  int   nResult = I2C_Fetch(pnSlaveNo, nullptr, pszResponse, pnResponseTime);
+  if ( ( nResult == -4 ) && ( nActive >= 0 ) )
+    return -1;                                  // busy
+  return nResult;
+}
+
+// See if ready for a request
+bool I2C_IsReady(uint8_t nPriority /*=I2C_PRIO_POLL*/)
+{
+  int   nFree = 0;
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+    if ( Slots[i].nState == I2C_SLOT_FREE )
+      ++nFree;
+  // the last free slot is kept for safety writes
+  return ( nFree > 1 ) || ( ( nFree == 1 ) && ( nPriority >= I2C_PRIO_SAFETY ) );
+}
+
+// See if request has been fulfilled
+bool I2C_HasReply()
+{
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+    if ( ( Slots[i].nState == I2C_SLOT_DONE ) || ( Slots[i].nState == I2C_SLOT_TIMEOUT ) )
+      return true;
+  return false;
+}
+
+// Max response length
+int I2C_ResponseMax(int nSlaveNo)
+{
+  return IsLegacy(nSlaveNo) ? I2C_RESPONSE_MAX : min(I2C_FRAMED_MAX, I2C_DATA_MAX);
+}
+
+// Response timeout of a slave
+unsigned long I2C_Timeout(int nSlaveNo)
+{
+  I2C_SlaveStats & stats = FindSlave(nSlaveNo);
+  if ( stats.usecRttAvg == 0 )
+    return I2C_TIMEOUT_MAX_US;                  // not yet measured
+  unsigned long usecTimeout = stats.usecRttAvg + 4 * stats.usecRttDev;
+  usecTimeout = max(usecTimeout, I2C_TIMEOUT_MIN_US) << stats.nBackoff;
+  return min(usecTimeout, I2C_TIMEOUT_MAX_US);
+}
+
+// Select the bus speed
+void I2C_SetFrequency(long nFrequency)
+{
+  nNextFrequency = nFrequency;
+}
+
+// Bus speed in use
+long I2C_Frequency()
+{
+  return nBusFrequency;
+}
+
+// Reset statistics
+void I2C_ResetStats()
+{
+  nTransactions = 0;
+  nBusBytes = 0;
+  nBusBits = 0;
+  nLegacyBits = 0;
+  nQueueFull = 0;
+  nQueueDepthMax = 0;
+  nRecoveries = 0;
+  nReleased = 0;
+  nStuck = 0;
+  nFallbacks = 0;
+  for ( int i = 0; i < I2C_SLAVES_MAX; ++i )
+  {                                             // keep the round trip estimates
+    SlaveStats[i].usecRttMax = 0;
+    SlaveStats[i].nTimeouts = 0;
+    SlaveStats[i].nRetries = 0;
+    SlaveStats[i].nNacks = 0;
+    SlaveStats[i].nTransactions = 0;
+    SlaveStats[i].nBytesOut = 0;
+    SlaveStats[i].nBytesIn = 0;
+    SlaveStats[i].nTooLong = 0;
+    SlaveStats[i].nBusy = 0;
+  }
+#if I2C_TRACE
+  nTraceCount = 0;
+#endif
+}
+
+// Print statistics
+void I2C_PrintStats(Print & out)
+{
+  out.print(F("# I2C transactions="));
+  out.print(nTransactions);
+  out.print(F(" bytes="));
+  out.print(nBusBytes);
+  out.print(F(" queue max="));
+  out.print(nQueueDepthMax);
+  out.print(F(" full="));
+  out.println(nQueueFull);
+  out.print(F("# bus kHz="));
+  out.print(nBusFrequency / 1000);
+  out.print(F(" fallbacks="));
+  out.print(nFallbacks);
+  out.print(F(" recoveries="));
+  out.print(nRecoveries);
+  out.print(F(" released="));
+  out.print(nReleased);
+  out.print(F(" stuck="));
+  out.println(nStuck);
+  for ( int i = 0; i < I2C_SLAVES_MAX; ++i )
+  {
+    const I2C_SlaveStats & stats = SlaveStats[i];
+    if ( stats.nSlaveNo == 0 )
+      continue;
+    out.print(F("# slave "));
+    out.print(stats.nSlaveNo);
+    out.print(F(" transactions="));
+    out.print(stats.nTransactions);
+    out.print(F(" out="));
+    out.print(stats.nBytesOut);
+    out.print(F(" in="));
+    out.print(stats.nBytesIn);
+    out.print(F(" toolong="));
+    out.print(stats.nTooLong);
+    out.print(F(" busy="));
+    out.println(stats.nBusy);
+    out.print(F("# slave "));
+    out.print(stats.nSlaveNo);
+    out.print(F(" rtt="));
+    out.print(stats.usecRttAvg);
+    out.print(F(" dev="));
+    out.print(stats.usecRttDev);
+    out.print(F(" max="));
+    out.print(stats.usecRttMax);
+    out.print(F(" timeout="));
+    out.print(I2C_Timeout(stats.nSlaveNo));
+    out.print(F(" timeouts="));
+    out.print(stats.nTimeouts);
+    out.print(F(" retries="));
+    out.print(stats.nRetries);
+    out.print(F(" nacks="));
+    out.println(stats.nNacks);
+  }
+  if ( nTransactions == 0 )
+    return;
+  // bus time per transaction in usec, bits * 1000 / kHz
+  long  nBusKHz = nBusFrequency / 1000;
+  long  usecBus = (long)( nBusBits / nTransactions ) * 1000 / nBusKHz;
+  long  usecPadded = (long)( nLegacyBits / nTransactions ) * 1000 / nBusKHz;
+  out.print(F("# bus usec/transaction="));
+  out.print(usecBus);
+  out.print(F(" padded="));
+  out.print(usecPadded);
+  out.print(F(" saved="));
+  out.println(usecPadded - usecBus);
+  if ( ( nRecords == 0 ) && ( nRecordsDropped == 0 ) )
+    return;
+  out.print(F("# records="));
+  out.print(nRecords);
+  out.print(F(" dropped="));
+  out.println(nRecordsDropped);
+}
+
+// Print the trace
+void I2C_PrintTrace(Print & out)
+{
+#if I2C_TRACE
+  for ( int i = 0; i < nTraceCount; ++i )
+  {                                             // oldest first
+    const I2C_TraceEntry & entry = Trace[( nTraceNext + I2C_TRACE_SIZE - nTraceCount + i ) % I2C_TRACE_SIZE];
+    out.print(F("# "));
+    out.print(entry.msecStart);
+    out.print(F(" +"));
+    out.print(entry.usecDuration);
+    out.print(F("us "));
+    out.print(entry.nSlaveNo);
+    out.print(F(": "));
+    PrintTraceBytes(out, entry.Request, entry.nRequestLength);
+    out.print(F(" -> "));
+    if ( entry.nResult < 0 )
+      out.println(F("timeout"));
+    else
+    {
+      PrintTraceBytes(out, entry.Response, entry.nResult);
+      out.println();
+    }
+  }
+#else
+  out.println(F("# no trace, built without I2C_TRACE"));
+#endif
+}
+
+// Record transactions
+void I2C_SetRecorder(HardwareSerial * pOut, const uint8_t * pState, uint8_t nStateLength)
+{
+  pRecorder = pOut;
+  if ( pRecorder != nullptr )                   // state record first, what was learned before
+    WriteRecord(0, 0, nStateLength, 0, LegacySlaves, sizeof(LegacySlaves), pState);
+}
+
+// Recorder counters
+unsigned long I2C_Recorded(unsigned long * pnDropped)
+{
+  *pnDropped = nRecordsDropped;
+  return nRecords;
+}
+
+#if I2C_REPLAY
+// Replay mode
+void I2C_SetReplay(bool bReplayOn, unsigned long usecStart)
+{
+  bReplay = bReplayOn;
+  usecReplayStart = usecStart;
+}
+
+// Take the slaves of a state record
+void I2C_ReplayState(const uint8_t * pLegacySlaves)
+{
+  memcpy(LegacySlaves, pLegacySlaves, sizeof(LegacySlaves));
+}
+
+// Requests expired in replay mode
+unsigned long I2C_ReplayExpired()
+{
+  return nReplayExpired;
+}
+
+// Replay a recorded result
+int I2C_Replay(int nSlaveNo, bool bLegacySlave, uint8_t nTag, const uint8_t * pRecorded, int nRecordedLength,
+               const uint8_t * pResponse, int nResult, unsigned long nResponseTime)
+{
+  if ( bLegacySlave )
+    LegacySlaves[( nSlaveNo >> 3 ) & 0x0F] |= 1 << ( nSlaveNo & 7 ); // as learned from the header byte
+  int   nSlot = -1;
+  int   nFree = -1;
+  for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+  {
+    if ( Slots[i].nState == I2C_SLOT_FREE )
+    {
+      if ( nFree < 0 )
+        nFree = i;
+      continue;
+    }
+    if (   ( Slots[i].nState == I2C_SLOT_QUEUED ) && ( Slots[i].nSlaveNo == nSlaveNo ) && ( Slots[i].nTag == nTag )
+        && ( ( nSlot < 0 ) || ( (long)( Slots[i].nSequence - Slots[nSlot].nSequence ) < 0 ) ) )
+      nSlot = i;
+  }
+  int   nMatch;
+  if ( nSlot >= 0 )
+  {                                             // the request recorded is the one under way, recorded again
+    nMatch = (   ( Slots[nSlot].nLength == nRecordedLength )
+              && ( memcmp(Slots[nSlot].szText, pRecorded, nRecordedLength) == 0 ) ) ? 0 : 1;
+    nRequestLength = Slots[nSlot].nLength;
+    memcpy(Request, Slots[nSlot].szText, nRequestLength);
+    for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+    {                                           // served before it in the field, but not recorded
+      if (   ( i != nSlot ) && ( Slots[i].nState == I2C_SLOT_QUEUED )
+          && (   ( Slots[i].nPriority > Slots[nSlot].nPriority )
+              || (   ( Slots[i].nPriority == Slots[nSlot].nPriority )
+                  && ( (long)( Slots[i].nSequence - Slots[nSlot].nSequence ) < 0 ) ) ) )
+        ExpireRequest(Slots[i]);
+    }
+  }
+  else if ( nFree >= 0 )
+  {                                             // the controller did not ask for it
+    unsigned long usecStart = micros() - nResponseTime;
+    for ( int i = 0; i < I2C_QUEUE_SIZE; ++i )
+    {                                           // queued before it started, served before it in the field
+      if ( ( Slots[i].nState == I2C_SLOT_QUEUED ) && ( (long)( usecStart - Slots[i].usecQueued ) > 0 ) )
+        ExpireRequest(Slots[i]);
+    }
+    nMatch = 2;
+    nSlot = nFree;
+    Slots[nSlot].nSlaveNo = nSlaveNo;
+    Slots[nSlot].nTag = nTag;
+    Slots[nSlot].nPriority = I2C_PRIO_POLL;
+    nRequestLength = min(nRecordedLength, I2C_DATA_MAX);
+    memcpy(Request, pRecorded, nRequestLength);
+  }
+  else
+    return -1;                                  // queue full, dropped
+
+  I2C_Slot & slot = Slots[nSlot];
+  slot.nLength = max(min(nResult, I2C_DATA_MAX), 0);
+  memcpy(slot.szText, pResponse, slot.nLength);
+  slot.szText[slot.nLength] = 0;
+  slot.nResponseTime = nResponseTime;
+  slot.nSequence = nSequenceNext++;             // fetched in order of completion
+  slot.nState = ( nResult >= 0 ) ? I2C_SLOT_DONE : I2C_SLOT_TIMEOUT;
+  RecordTransaction(slot, ( nResult >= 0 ) ? slot.nLength : -3);
+  return nMatch;
+}
+#endif
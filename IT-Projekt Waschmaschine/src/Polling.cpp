@@ -0,0 +1,272 @@
+/* Priority and freshness driven poll scheduler
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include poll scheduler
+#include "Polling.h"
+
+                                                // poll scheduler data
+//! command table in flash
+static const CommandDesc * pCommandTable = nullptr;
+//! number of entries
+static int            nCommandCount = 0;
+//! current program phase
+static uint8_t        nCurrentPhase = PH_IDLE;
+//! runtime data per entry, as many as the command table has
+static PollState *    pPollStates = nullptr;
+//! entries of the outstanding request not yet received, one bit per entry
+static uint16_t       nBatchMissing = 0;
+//! number of values of the outstanding request
+static uint8_t        nBatchCount = 0;
+//! batched requests allowed
+static bool           bBatching = true;
+//! change driven polling
+static bool           bChangeDriven = false;
+//! short batch responses in a row
+static uint8_t        nShortInRow = 0;
+//! number of poll transactions
+static unsigned long  nTransactions = 0;
+//! number of polled values
+static unsigned long  nValues = 0;
+//! number of batches answered with fewer values than requested
+static unsigned long  nShortBatches = 0;
+
+//! Refresh interval of an entry in the current phase
+static uint8_t Refresh(int nIndex)
+{
+  return pgm_read_byte(&pCommandTable[nIndex].Refresh[nCurrentPhase]);
+}
+
+// Poll scheduler setup
+void Poll_Setup(const CommandDesc * pTable, PollState * pStates, int nCount)
+{
+  if ( nCount > POLL_COMMANDS_MAX )
+    nCount = POLL_COMMANDS_MAX;                 // ignore the rest
+  pCommandTable = pTable;
+  pPollStates = pStates;
+  nCommandCount = nCount;
+  Poll_Restart();
+  Poll_ResetStats();
+}
+
+// Set the program phase
+void Poll_SetPhase(uint8_t nPhase)
+{
+  if ( nPhase < PH_COUNT )
+    nCurrentPhase = nPhase;
+}
+
+// Restart for a new wash program
+void Poll_Restart()
+{
+  for ( int i = 0; i < nCommandCount; ++i )
+    pPollStates[i].bValid = false;
+}
+
+//! Find the most urgent entry
+/*!
+Find the entry with the largest age relative to its refresh interval.
+\param nExclude entries to leave out, one bit per entry
+\param bDueOnly only entries at least as old as their refresh interval
+\param msecAge storage for the age of the entry found
+\return index of the entry, -1 if none
+*/
+static int MostUrgent(uint16_t nExclude, bool bDueOnly, unsigned long & msecAge)
+{
+  int           nBest = -1;
+  unsigned long msecBestAge = 0;
+  uint8_t       nBestRefresh = 1;
+
+  for ( int i = 0; i < nCommandCount; ++i )
+  {
+    if ( nExclude & ( 1U << i ) )
+      continue;
+    uint8_t       nRefresh = Refresh(i);
+    if ( nRefresh == POLL_NEVER )
+      continue;
+    if ( nRefresh == POLL_ONCE )
+    {
+      if ( pPollStates[i].bValid )
+        continue;                               // already got it
+      nRefresh = 1;
+    }
+    unsigned long msecAgeI = Poll_Age(i);
+    if ( pPollStates[i].bAtOnce )
+    {                                           // most urgent of all
+      msecAgeI = POLL_AGE_MAX;
+      nRefresh = 1;
+    }
+    else if ( bChangeDriven && ! pPollStates[i].bChanged && ( msecAgeI < POLL_AGE_MAX ) )
+      continue;                                 // unchanged
+    if ( bDueOnly && ( msecAgeI < nRefresh * (unsigned long)POLL_TICK_MS ) )
+      continue;
+    // compare age / refresh without division, both products fit into 32 bit
+    if ( ( nBest < 0 ) || ( msecAgeI * nBestRefresh > msecBestAge * nRefresh ) )
+    {
+      nBest = i;
+      msecBestAge = msecAgeI;
+      nBestRefresh = nRefresh;
+    }
+  }
+  msecAge = msecBestAge;
+  return nBest;
+}
+
+// Create the next poll
+int Poll_Next(char szCommand[], int nResponseMax)
+{
+  *szCommand = 0;
+  nBatchMissing = 0;
+  nBatchCount = 0;
+
+  int           nLength = 0;                    // request length
+  int           nResponse = 0;                  // expected max response length
+  uint16_t      nExclude = 0;                   // entries requested or left out
+  while ( nBatchCount < ( bBatching ? POLL_BATCH_MAX : 1 ) )
+  {
+    unsigned long msecAge;
+    int           nIndex = MostUrgent(nExclude, bChangeDriven || ( nBatchCount > 0 ), msecAge);
+    if ( nIndex < 0 )
+      break;                                    // nothing (more) to poll
+    CommandDesc desc;
+    Command_Get(pCommandTable, nIndex, desc);
+    if (   ( nBatchCount > 0 )
+        && ( nResponse + 1 + Command_ResponseLength(desc) > nResponseMax ) )
+      break;                                    // response would not fit
+    Command_Format(desc, szCommand + nLength);
+    nLength += strlen(szCommand + nLength);
+    nResponse += ( nBatchCount > 0 ? 1 : 0 ) + Command_ResponseLength(desc);
+    nExclude |= 1U << nIndex;
+    nBatchMissing |= 1U << nIndex;
+    ++nBatchCount;
+    ++pPollStates[nIndex].nPolls;
+    if ( msecAge > pPollStates[nIndex].msecAgeMax )
+      pPollStates[nIndex].msecAgeMax = msecAge;
+  }
+  if ( nBatchCount == 0 )
+    return 0;
+  ++nTransactions;
+  nValues += nBatchCount;
+  return nBatchCount;
+}
+
+// Complete a poll
+void Poll_Complete(bool bResponse)
+{
+  if ( bResponse && ( nBatchCount > 1 ) )
+  {
+    if ( nBatchMissing != 0 )
+    {
+      ++nShortBatches;
+      if ( ++nShortInRow >= POLL_BATCH_FALLBACK )
+        bBatching = false;                      // plant answers single values only
+    }
+    else
+      nShortInRow = 0;
+  }
+  nBatchMissing = 0;
+  nBatchCount = 0;
+}
+
+// Note a received value
+void Poll_Received(int nIndex)
+{
+  if ( ( nIndex < 0 ) || ( nIndex >= nCommandCount ) )
+    return;
+  pPollStates[nIndex].msecReceived = millis();
+  pPollStates[nIndex].bValid = true;
+  pPollStates[nIndex].bChanged = false;
+  pPollStates[nIndex].bAtOnce = false;
+  nBatchMissing &= ~( 1U << nIndex );
+}
+
+// Note a value received earlier
+void Poll_Preset(int nIndex, unsigned long msecAge)
+{
+  Poll_Received(nIndex);
+  if ( ( nIndex >= 0 ) && ( nIndex < nCommandCount ) )
+    pPollStates[nIndex].msecReceived -= msecAge;
+}
+
+// See if a value is flagged as changed
+bool Poll_IsChanged(int nIndex, bool * pbAtOnce)
+{
+  if ( ( nIndex < 0 ) || ( nIndex >= nCommandCount ) )
+    return false;
+  if ( pbAtOnce != nullptr )
+    *pbAtOnce = pPollStates[nIndex].bAtOnce;
+  return pPollStates[nIndex].bChanged;
+}
+
+// Select change driven polling
+void Poll_SetChangeDriven(bool bOn)
+{
+  bChangeDriven = bOn;
+}
+
+// Flag a changed value
+void Poll_Changed(int nIndex, bool bAtOnce)
+{
+  if ( ( nIndex < 0 ) || ( nIndex >= nCommandCount ) )
+    return;
+  pPollStates[nIndex].bChanged = true;
+  if ( bAtOnce )
+    pPollStates[nIndex].bAtOnce = true;
+}
+
+// Age of a value
+unsigned long Poll_Age(int nIndex)
+{
+  if ( ! pPollStates[nIndex].bValid )
+    return POLL_AGE_MAX;
+  unsigned long msecAge = millis() - pPollStates[nIndex].msecReceived;
+  return ( msecAge > POLL_AGE_MAX ) ? POLL_AGE_MAX : msecAge;
+}
+
+// Reset statistics
+void Poll_ResetStats()
+{
+  for ( int i = 0; i < nCommandCount; ++i )
+  {
+    pPollStates[i].nPolls = 0;
+    pPollStates[i].msecAgeMax = 0;
+  }
+  nTransactions = 0;
+  nValues = 0;
+  nShortBatches = 0;
+  nShortInRow = 0;
+  bBatching = true;
+}
+
+// Print statistics
+void Poll_PrintStats(Print & out)
+{
+  for ( int i = 0; i < nCommandCount; ++i )
+  {
+    uint8_t       nRefresh = Refresh(i);
+    if ( nRefresh == POLL_NEVER )
+      continue;
+    out.print(F("# "));
+    out.print((char)pgm_read_byte(&pCommandTable[i].cKey));
+    out.print(F(" refresh="));
+    if ( nRefresh == POLL_ONCE )
+      out.print(F("once"));
+    else
+      out.print(nRefresh * POLL_TICK_MS);
+    out.print(F(" age="));
+    out.print(Poll_Age(i));
+    out.print(F(" polls="));
+    out.print(pPollStates[i].nPolls);
+    out.print(F(" agemax="));
+    out.println(pPollStates[i].msecAgeMax);
+  }
+  out.print(F("# transactions="));
+  out.print(nTransactions);
+  out.print(F(" values="));
+  out.print(nValues);
+  out.print(F(" short="));
+  out.print(nShortBatches);
+  out.print(bBatching ? F(" batched") : F(" single"));
+  out.println(bChangeDriven ? F(" changes") : F(" freshness"));
+}
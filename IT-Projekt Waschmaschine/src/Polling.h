@@ -0,0 +1,173 @@
+/*! \page Polling Poll Scheduler
+Priority and freshness driven poll scheduler.
+
+The I²C bus carries one transaction per 100 msec cycle, so it has to be spent on the values that currently matter.
+Each entry of the command table has a refresh interval per program phase,
+e.g. the water level every cycle while filling, the temperature every cycle while heating,
+the laundry amount once per program (POLL_ONCE), see \link CommandTable Command Table \endlink.
+
+Every received value gets an age stamp.
+Poll_Next() picks the entry with the largest age relative to its refresh interval, so overdue values come first
+and free cycles go to the values closest to becoming due.
+Ties are broken by the order in the table.
+Values never received count as POLL_AGE_MAX old.
+
+Further values which are due are batched into the same request, e.g. "T?C?A?",
+as long as their responses fit into one I²C response (I2C_ResponseMax()), see \link CommandTable Command Table \endlink.
+If the plant answers POLL_BATCH_FALLBACK batches in a row with fewer values than requested,
+e.g. an older plant firmware answering the first one only, the scheduler falls back to single polls.
+
+With a plant reporting its changes the scheduler works change driven, see Poll_SetChangeDriven().
+A value the plant flags as changed, Poll_Changed(), is polled as soon as its refresh interval is over,
+a value flagged to be read at once, e.g. the warnings, is polled next regardless of its interval.
+Unchanged values are left alone until they are POLL_AGE_MAX old, so an idle plant costs no polls but the change status.
+
+Per entry the scheduler records the number of polls and the max age seen when polled,
+in total the number of transactions, polled values and short batch responses.
+*/
+
+#ifndef POLLING_H
+#define POLLING_H
+
+// include standard Arduino library
+#include <Arduino.h>
+// include command table
+#include "Commands.h"
+
+                                                // poll scheduler attributes
+//! max number of entries in a command table, one bit each in a batch
+const int       POLL_COMMANDS_MAX = 16;
+//! ages are limited to this value in msec
+const unsigned long POLL_AGE_MAX = 60000UL;
+//! max number of values in one batched request
+const int       POLL_BATCH_MAX = 8;
+//! short batch responses in a row before falling back to single polls
+const int       POLL_BATCH_FALLBACK = 3;
+
+//! poll runtime data per entry
+struct PollState
+{
+  unsigned long msecReceived;                   ///< time the value has been received
+  bool          bValid;                         ///< value has been received at all
+  bool          bChanged;                       ///< plant reports a change
+  bool          bAtOnce;                        ///< poll next, regardless of the refresh interval
+  unsigned int  nPolls;                         ///< number of polls
+  unsigned long msecAgeMax;                     ///< max age when polled
+};
+
+                                                // poll scheduler prototypes
+//! Poll scheduler setup
+/*!
+Poll scheduler setup.
+The command table and the runtime data have to remain in existence, they are not copied.
+\param pTable command table in flash
+\param pStates runtime data, one per entry
+\param nCount number of entries, at most POLL_COMMANDS_MAX
+*/
+extern void Poll_Setup(const CommandDesc * pTable, PollState * pStates, int nCount);
+
+//! Poll scheduler setup with runtime data sized to the command table
+/*!
+Poll scheduler setup for a static command table, the runtime data is allocated for exactly its entries.
+\param Table static command table in flash
+*/
+template <int nCount> void Poll_Setup(const CommandDesc (&Table)[nCount])
+{
+  static_assert(nCount <= POLL_COMMANDS_MAX, "command table too long, one bit per entry in a batch");
+  static PollState States[nCount];
+  Poll_Setup(Table, States, nCount);
+}
+
+//! Set the program phase
+/*!
+Set the program phase which selects the refresh intervals.
+\param nPhase see PollPhase
+*/
+extern void Poll_SetPhase(uint8_t nPhase);
+
+//! Restart for a new wash program
+/*!
+Mark all values as never received, so every value and the POLL_ONCE values are read again.
+*/
+extern void Poll_Restart();
+
+//! Select change driven polling
+/*!
+Select change driven polling, only values flagged by Poll_Changed() and values POLL_AGE_MAX old are polled.
+\param bOn true for change driven, false for freshness driven polling
+*/
+extern void Poll_SetChangeDriven(bool bOn);
+
+//! Flag a changed value
+/*!
+Flag a value the plant reports as changed since it has been read.
+\param nIndex index in the command table
+\param bAtOnce poll it next, regardless of its refresh interval
+*/
+extern void Poll_Changed(int nIndex, bool bAtOnce);
+
+//! Create the next poll
+/*!
+Create the request for the most urgent entry, batched with further due entries.
+\param szCommand storage for the request, at least 2 * POLL_BATCH_MAX + 1 bytes
+\param nResponseMax max response length, limits the batch
+\return number of values requested, 0 if there is nothing to poll
+*/
+extern int Poll_Next(char szCommand[], int nResponseMax);
+
+//! Complete a poll
+/*!
+Complete the current I²C transaction, checks whether all values of a batch have been received.
+To be called after the response has been interpreted and on timeout.
+\param bResponse true if there has been a response
+*/
+extern void Poll_Complete(bool bResponse);
+
+//! Note a received value
+/*!
+Note a received value, sets its age stamp.
+\param nIndex index in the command table
+*/
+extern void Poll_Received(int nIndex);
+
+//! Note a value received earlier
+/*!
+Note a value received some time ago, e.g. taken from the state record a replay continues with.
+\param nIndex index in the command table
+\param msecAge msec since the value has been received
+*/
+extern void Poll_Preset(int nIndex, unsigned long msecAge);
+
+//! See if a value is flagged as changed
+/*!
+See if the plant has reported a change of a value not yet polled, see Poll_Changed().
+\param nIndex index in the command table
+\param pbAtOnce set to true if it is to be polled next, may be nullptr
+\return true if flagged as changed
+*/
+extern bool Poll_IsChanged(int nIndex, bool * pbAtOnce = nullptr);
+
+//! Age of a value
+/*!
+Age of a value.
+\param nIndex index in the command table
+\return msec since the value has been received, POLL_AGE_MAX if never or longer
+*/
+extern unsigned long Poll_Age(int nIndex);
+
+//! Reset statistics
+/*!
+Reset poll counts and max ages, keeps the age stamps.
+Tries batched requests again after a fall back.
+*/
+extern void Poll_ResetStats();
+
+//! Print statistics
+/*!
+Print per entry: current refresh interval in msec, age, polls and max age in msec,
+then transactions, values, short batches, batched or single and change or freshness driven.
+\param out output stream, typically Serial
+*/
+extern void Poll_PrintStats(Print & out);
+
+#endif // POLLING_H
@@ -0,0 +1,98 @@
+/* Execution time profiler
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include profiler
+#include "Profiler.h"
+
+#if PROFILER_ENABLED
+
+//! measurements of one code section
+struct ProfileData
+{
+  unsigned long nCount;                         ///< number of measurements in usecSum
+  unsigned long usecSum;                        ///< sum of durations for the average
+  unsigned long usecMin;                        ///< shortest duration
+  unsigned long usecMax;                        ///< longest duration
+  uint16_t      nBucket[PROF_BUCKETS];          ///< histogram, saturating counts
+};
+
+                                                // profiler data
+//! measurements per section
+static ProfileData    Profile[PROF_COUNT];
+                                                // names per section, in flash
+static const char     szLoop[] PROGMEM = "loop";
+static const char     szTask10ms[] PROGMEM = "Task_10ms";
+static const char     szTask100ms[] PROGMEM = "Task_100ms";
+static const char     szTask1s[] PROGMEM = "Task_1s";
+static const char     szShowData[] PROGMEM = "ShowData";
+static const char     szInterprete[] PROGMEM = "InterpreteResponse";
+static const char     szMasterSteady[] PROGMEM = "I2C_Master_Steady";
+//! names per section
+static const char * const ProfileNames[PROF_COUNT] PROGMEM =
+{
+  szLoop, szTask10ms, szTask100ms, szTask1s, szShowData, szInterprete, szMasterSteady
+};
+
+// Record a measured duration
+void Profiler_Record(ProfileId nId, unsigned long usecDuration)
+{
+  ProfileData & data = Profile[nId];
+
+  if ( usecDuration > 0xFFFFFFFFUL - data.usecSum )
+  {                                             // sum would overflow, keep the average
+    data.usecSum /= 2;
+    data.nCount /= 2;
+  }
+  if ( ( data.nCount == 0 ) || ( usecDuration < data.usecMin ) )
+    data.usecMin = usecDuration;
+  data.usecSum += usecDuration;
+  ++data.nCount;
+  if ( usecDuration > data.usecMax )
+    data.usecMax = usecDuration;
+
+  int   nBucket = 0;                            // logarithmic bucket
+  for ( unsigned long usecLimit = 16; ( usecDuration >= usecLimit ) && ( nBucket < PROF_BUCKETS-1 ); usecLimit <<= 1 )
+    ++nBucket;
+  if ( data.nBucket[nBucket] != 0xFFFF )
+    ++data.nBucket[nBucket];
+}
+
+// Reset all measurements
+void Profiler_Reset()
+{
+  memset(Profile, 0, sizeof(Profile));
+}
+
+// Print all measurements
+void Profiler_Print(Print & out)
+{
+  for ( int i = 0; i < PROF_COUNT; ++i )
+  {
+    const ProfileData & data = Profile[i];
+    out.print(F("# "));
+    out.print((const __FlashStringHelper *)pgm_read_ptr(&ProfileNames[i]));
+    out.print(F(" n="));
+    out.print(data.nCount);
+    if ( data.nCount > 0 )
+    {
+      out.print(F(" min="));
+      out.print(data.usecMin);
+      out.print(F(" avg="));
+      out.print(data.usecSum / data.nCount);
+      out.print(F(" max="));
+      out.print(data.usecMax);
+      out.print(F(" hist="));
+      for ( int n = 0; n < PROF_BUCKETS; ++n )
+      {
+        if ( n > 0 )
+          out.print(',');
+        out.print(data.nBucket[n]);
+      }
+    }
+    out.println();
+  }
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*! \page Profiler Profiler
+Execution time profiler.
+
+Measures execution times with micros() for a fixed set of code sections.
+Per section it keeps count, min, average, max and a histogram with logarithmic buckets:
+bucket 0 counts times below 16 usec, bucket n times from 16*2^(n-1) up to 16*2^n usec,
+the last bucket all longer times.
+
+Use PROFILE_BEGIN(id) and PROFILE_END(id) in the same block around a section.
+With PROFILER_ENABLED set to 0 (build flag -DPROFILER_ENABLED=0) both macros are empty
+and no code or RAM is spent at all.
+
+Note micros() has a resolution of 4 usec on a 16 MHz Arduino UNO.
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+
+#ifndef PROFILER_ENABLED
+//! profiler switch, 0 removes all profiling code
+#define PROFILER_ENABLED 1
+#endif
+
+                                                // profiler attributes
+//! profiled code sections
+enum ProfileId
+{
+  PROF_LOOP,                                    ///< one pass of loop()
+  PROF_TASK_10MS,                               ///< Task_10ms()
+  PROF_TASK_100MS,                              ///< Task_100ms()
+  PROF_TASK_1S,                                 ///< Task_1s()
+  PROF_SHOWDATA,                                ///< ShowData()
+  PROF_INTERPRETE,                              ///< InterpreteResponse()
+  PROF_I2C_STEADY,                              ///< I2C_Master_Steady()
+  PROF_COUNT                                    ///< number of sections
+};
+
+//! number of histogram buckets
+const int       PROF_BUCKETS = 10;
+
+#if PROFILER_ENABLED
+
+//! start measuring a section
+#define PROFILE_BEGIN(id)   unsigned long usecProfileStart_##id = micros()
+//! stop measuring a section and record its duration
+#define PROFILE_END(id)     Profiler_Record(id, micros() - usecProfileStart_##id)
+
+                                                // profiler prototypes
+//! Record a measured duration
+/*!
+Record a measured duration.
+\param nId code section
+\param usecDuration execution time in usec
+*/
+extern void Profiler_Record(ProfileId nId, unsigned long usecDuration);
+
+//! Reset all measurements
+extern void Profiler_Reset();
+
+//! Print all measurements
+/*!
+Print count, min/avg/max in usec and the histogram for all sections.
+\param out output stream, typically Serial
+*/
+extern void Profiler_Print(Print & out);
+
+#else
+
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id)
+
+#endif
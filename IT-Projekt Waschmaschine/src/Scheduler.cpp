@@ -0,0 +1,111 @@
+/* Cooperative deadline scheduler
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include scheduler
+#include "Scheduler.h"
+
+                                                // scheduler data
+//! static task table
+static const SchedTask * pTaskTable = nullptr;
+//! number of tasks
+static int            nTaskCount = 0;
+//! runtime data per task, as many as the task table has
+static SchedState *   pTaskState = nullptr;
+
+// Scheduler setup
+void Scheduler_Setup(const SchedTask * pTasks, SchedState * pStates, int nTasks)
+{
+  pTaskTable = pTasks;
+  pTaskState = pStates;
+  nTaskCount = nTasks;
+
+  unsigned long usecNow = micros();
+  for ( int i = 0; i < nTaskCount; ++i )
+  {
+    pTaskState[i].usecDue = usecNow + pTaskTable[i].msecPhase * 1000UL;
+    pTaskState[i].nBacklog = 0;
+  }
+  Scheduler_ResetStats();
+}
+
+// Run the next due task
+int Scheduler_Run()
+{
+  unsigned long usecNow = micros();
+  int           nBest = -1;
+
+  for ( int i = 0; i < nTaskCount; ++i )
+  {                                             // find due task with highest priority
+    if ( (long)( usecNow - pTaskState[i].usecDue ) < 0 )
+      continue;                                 // not yet due
+    if ( ( nBest < 0 ) || ( pTaskTable[i].nPriority > pTaskTable[nBest].nPriority ) )
+      nBest = i;
+  }
+  if ( nBest < 0 )
+    return -1;                                  // nothing to do
+
+  const SchedTask & task = pTaskTable[nBest];
+  SchedState &      state = pTaskState[nBest];
+  unsigned long     usecPeriod = task.msecPeriod * 1000UL;
+  unsigned long     usecLate = usecNow - state.usecDue;
+
+  state.usecDue += usecPeriod;                  // next activation on the grid
+  if ( state.nBacklog > 0 )
+    --state.nBacklog;                           // catching up, late by intention
+  else if ( usecLate < usecPeriod )
+  {                                             // in time
+    if ( usecLate > state.usecJitterMax )
+      state.usecJitterMax = usecLate;
+  }
+  else
+  {                                             // overrun, at least one activation missed
+    ++state.nOverruns;
+    unsigned long nMissed = usecLate / usecPeriod;
+    unsigned long nKeep = ( task.nPolicy == SCHED_CATCH_UP ) ? SCHED_CATCH_UP_MAX : 0;
+    if ( nMissed > nKeep )
+    {                                           // drop the rest, stay on the grid
+      state.nDropped += nMissed - nKeep;
+      state.usecDue += ( nMissed - nKeep ) * usecPeriod;
+      nMissed = nKeep;
+    }
+    state.nBacklog = nMissed;
+    if ( usecLate > state.usecJitterMax )
+      state.usecJitterMax = usecLate;
+  }
+
+  ++state.nRuns;
+  task.pfnTask();
+  return nBest;
+}
+
+// Reset statistics
+void Scheduler_ResetStats()
+{
+  for ( int i = 0; i < nTaskCount; ++i )
+  {
+    pTaskState[i].nRuns = 0;
+    pTaskState[i].nOverruns = 0;
+    pTaskState[i].nDropped = 0;
+    pTaskState[i].usecJitterMax = 0;
+  }
+}
+
+// Print statistics
+void Scheduler_PrintStats(Print & out)
+{
+  for ( int i = 0; i < nTaskCount; ++i )
+  {
+    out.print(F("# "));
+    out.print((const __FlashStringHelper *)pTaskTable[i].pszName);
+    out.print(F(" runs="));
+    out.print(pTaskState[i].nRuns);
+    out.print(F(" overruns="));
+    out.print(pTaskState[i].nOverruns);
+    out.print(F(" dropped="));
+    out.print(pTaskState[i].nDropped);
+    out.print(F(" jitter="));
+    out.println(pTaskState[i].usecJitterMax);
+  }
+}
@@ -0,0 +1,90 @@
+/*! \page Scheduler Scheduler
+Cooperative deadline scheduler.
+
+All periodic tasks are listed in one static task table with period, phase offset and priority.
+Every call of Scheduler_Run() starts at most one task, the due task with the highest priority.
+Ties are broken by the order in the table.
+
+Due times are kept on a fixed grid of phase + n * period in microseconds,
+so late starts never shift later activations.
+A task started later than one full period has overrun.
+Its missed activations are either run back to back (SCHED_CATCH_UP, limited to SCHED_CATCH_UP_MAX)
+or dropped (SCHED_SKIP), both deterministically and counted.
+
+Per task the scheduler records runs, overruns, dropped activations and the maximal start jitter.
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // scheduler attributes
+//! max number of missed activations run back to back
+const int       SCHED_CATCH_UP_MAX = 3;
+
+//! overrun policies
+enum SchedPolicy { SCHED_SKIP, SCHED_CATCH_UP };
+
+//! static task description
+struct SchedTask
+{
+  void          (*pfnTask)();                   ///< task function
+  const char *  pszName;                        ///< name for statistics, in flash (PROGMEM)
+  unsigned int  msecPeriod;                     ///< period in msec
+  unsigned int  msecPhase;                      ///< phase offset in msec
+  uint8_t       nPriority;                      ///< higher value wins
+  uint8_t       nPolicy;                        ///< see SchedPolicy
+};
+
+//! task runtime data
+struct SchedState
+{
+  unsigned long usecDue;                        ///< next due time in usec
+  unsigned long nRuns;                          ///< number of runs
+  unsigned long nOverruns;                      ///< number of starts later than one period
+  unsigned long nDropped;                       ///< number of activations not run at all
+  unsigned long usecJitterMax;                  ///< max delay between due time and start
+  uint8_t       nBacklog;                       ///< missed activations still to catch up
+};
+
+                                                // scheduler prototypes
+//! Scheduler setup
+/*!
+Scheduler setup.
+The task table and the runtime data have to remain in existence, they are not copied.
+\param pTasks static task table
+\param pStates runtime data, one per task
+\param nTasks number of tasks
+*/
+extern void Scheduler_Setup(const SchedTask * pTasks, SchedState * pStates, int nTasks);
+
+//! Scheduler setup with runtime data sized to the task table
+/*!
+Scheduler setup for a static task table, the runtime data is allocated for exactly its tasks.
+\param Tasks static task table
+*/
+template <int nTasks> void Scheduler_Setup(const SchedTask (&Tasks)[nTasks])
+{
+  static SchedState States[nTasks];
+  Scheduler_Setup(Tasks, States, nTasks);
+}
+
+//! Run the next due task
+/*!
+Run the next due task, if any.
+To be called from loop() as often as possible.
+\return index of the task run, -1 if none was due
+*/
+extern int Scheduler_Run();
+
+//! Reset statistics
+/*!
+Reset all statistics, keeps the schedule.
+*/
+extern void Scheduler_ResetStats();
+
+//! Print statistics
+/*!
+Print statistics per task: runs, overruns, dropped activations and max jitter in usec.
+\param out output stream, typically Serial
+*/
+extern void Scheduler_PrintStats(Print & out);
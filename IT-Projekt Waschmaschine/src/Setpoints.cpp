@@ -0,0 +1,235 @@
+/* Change driven setpoint writes
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include setpoint shadow registers
+#include "Setpoints.h"
+
+//! static setpoint description
+struct SetpointDesc
+{
+  char          cKey;                           ///< command character
+  bool          bOneShot;                       ///< action, not repeated after a plant reset
+};
+
+//! setpoint runtime data, the shadow register
+struct SetpointState
+{
+  int           nDesired;                       ///< value the controller wants
+  int           nAcked;                         ///< value acknowledged by the plant
+  int           nSent;                          ///< value of the last write
+  bool          bPending;                       ///< a write is needed
+  bool          bRetryWait;                     ///< last write failed, wait before repeating
+  bool          bOutstanding;                   ///< write queued, not yet complete
+  bool          bRenewed;                       ///< set again while the write was outstanding
+  unsigned long msecSent;                       ///< time of the last write
+  unsigned int  nWrites;                        ///< number of writes
+  unsigned int  nRetries;                       ///< number of repeated writes
+  unsigned int  nRejected;                      ///< number of writes acknowledged with another value
+  unsigned int  nUnknown;                       ///< number of one shot writes without acknowledge
+};
+
+                                                // setpoint data
+//! setpoint descriptions in the order of SetpointId
+static const SetpointDesc SetpointTable[SP_COUNT] =
+{
+  { 'D', false },                               // door closed
+  { 'r', false },                               // drum speed
+  { 'O', true },                                // dose detergent
+  { 'o', true },                                // dose softener
+};
+//! shadow registers
+static SetpointState  Setpoints[SP_COUNT];
+
+// Set a desired value
+void Setpoint_Set(uint8_t nId, int nValue, bool bAlways)
+{
+  if ( nId >= SP_COUNT )
+    return;
+  SetpointState & sp = Setpoints[nId];
+  sp.nDesired = nValue;
+  if ( sp.bOutstanding )
+    sp.bRenewed = true;                         // a one shot action is wanted once more
+  if ( bAlways || ( nValue != sp.nAcked ) )
+  {
+    if ( ! sp.bPending )
+      sp.bRetryWait = false;                    // new value, write at once
+    sp.bPending = true;
+  }
+  else if ( ! sp.bOutstanding )
+    sp.bPending = false;                        // back to the acknowledged value
+}
+
+// Get the desired value
+int Setpoint_Desired(uint8_t nId)
+{
+  return ( nId < SP_COUNT ) ? Setpoints[nId].nDesired : 0;
+}
+
+// See if a setpoint is acknowledged
+bool Setpoint_IsAcked(uint8_t nId)
+{
+  return ( nId < SP_COUNT ) && ! Setpoints[nId].bPending;
+}
+
+// Get the acknowledged value
+int Setpoint_Acked(uint8_t nId)
+{
+  return ( nId < SP_COUNT ) ? Setpoints[nId].nAcked : 0;
+}
+
+// Preset the acknowledged value
+void Setpoint_Preset(uint8_t nId, int nValue)
+{
+  if ( nId >= SP_COUNT )
+    return;
+  SetpointState & sp = Setpoints[nId];
+  sp.nAcked = nValue;
+  sp.bRetryWait = false;
+  if ( ! SetpointTable[nId].bOneShot )
+    sp.bPending = ( sp.nDesired != nValue );
+}
+
+// Find the setpoint of a command
+int Setpoint_Find(const char * pszCommand)
+{
+  if ( pszCommand[1] != '=' )
+    return -1;
+  for ( int i = 0; i < SP_COUNT; ++i )
+    if ( SetpointTable[i].cKey == pszCommand[0] )
+      return i;
+  return -1;
+}
+
+// Find the next pending write
+int Setpoint_Peek()
+{
+  unsigned long msecNow = millis();
+  for ( int i = 0; i < SP_COUNT; ++i )
+  {
+    const SetpointState & sp = Setpoints[i];
+    if ( ! sp.bPending || sp.bOutstanding )
+      continue;
+    if ( sp.bRetryWait && ( ( msecNow - sp.msecSent ) < SETPOINT_RETRY_MS ) )
+      continue;                                 // not yet
+    return i;
+  }
+  return -1;
+}
+
+// Create the next pending write
+int Setpoint_Next(char szCommand[])
+{
+  *szCommand = 0;
+  int   nId = Setpoint_Peek();
+  if ( nId < 0 )
+    return -1;
+  SetpointState & sp = Setpoints[nId];
+  if ( sp.bRetryWait )
+    ++sp.nRetries;
+  szCommand[0] = SetpointTable[nId].cKey;
+  szCommand[1] = '=';
+  itoa(sp.nDesired, szCommand+2, 10);
+  sp.nSent = sp.nDesired;
+  sp.msecSent = millis();
+  ++sp.nWrites;
+  sp.bOutstanding = true;
+  return nId;
+}
+
+// Take back a write not sent
+void Setpoint_Withdraw(uint8_t nId)
+{
+  if ( ( nId >= SP_COUNT ) || ! Setpoints[nId].bOutstanding )
+    return;
+  SetpointState & sp = Setpoints[nId];
+  sp.bOutstanding = false;
+  sp.bRenewed = false;                          // still pending anyway
+  --sp.nWrites;
+  if ( sp.bRetryWait )
+  {
+    --sp.nRetries;
+    sp.msecSent -= SETPOINT_RETRY_MS;           // due again right away
+  }
+}
+
+// Complete a write
+bool Setpoint_Complete(uint8_t nId, const char * pszResponse)
+{
+  if (   ( pszResponse == nullptr )
+      || ( pszResponse[0] == 0 )
+      || ( pszResponse[1] != '=' ) )
+    return Setpoint_Acknowledge(nId, 0, 0);     // no acknowledge
+  return Setpoint_Acknowledge(nId, pszResponse[0], atoi(pszResponse+2));
+}
+
+// Complete a write with a value
+bool Setpoint_Acknowledge(uint8_t nId, char cKey, int nValue)
+{
+  if ( ( nId >= SP_COUNT ) || ! Setpoints[nId].bOutstanding )
+    return false;                               // no write under way
+  SetpointState & sp = Setpoints[nId];
+  bool          bRenewed = sp.bRenewed;
+  sp.bOutstanding = false;
+  sp.bRenewed = false;
+
+  if ( cKey != SetpointTable[nId].cKey )
+  {
+    if ( SetpointTable[nId].bOneShot )
+    {                                           // may have been done, never do it twice
+      ++sp.nUnknown;
+      sp.bPending = bRenewed;
+      sp.bRetryWait = false;
+      return false;
+    }
+    sp.bRetryWait = true;                       // no acknowledge, repeat later
+    return false;
+  }
+
+  sp.nAcked = nValue;
+  sp.bRetryWait = false;
+  if ( sp.nAcked != sp.nSent )
+    ++sp.nRejected;                             // plant took another value
+  if ( SetpointTable[nId].bOneShot )
+    sp.bPending = bRenewed;                     // done once per Setpoint_Set()
+  else if ( sp.nDesired == sp.nSent )
+    sp.bPending = false;                        // done, the plant has the last word
+  return true;
+}
+
+// Invalidate all acknowledges
+void Setpoint_Invalidate()
+{
+  for ( int i = 0; i < SP_COUNT; ++i )
+  {
+    if ( SetpointTable[i].bOneShot )
+      continue;
+    Setpoints[i].bPending = true;
+    Setpoints[i].bRetryWait = false;
+  }
+}
+
+// Print statistics
+void Setpoint_PrintStats(Print & out)
+{
+  for ( int i = 0; i < SP_COUNT; ++i )
+  {
+    out.print(F("# "));
+    out.print(SetpointTable[i].cKey);
+    out.print(F(" desired="));
+    out.print(Setpoints[i].nDesired);
+    out.print(F(" acked="));
+    out.print(Setpoints[i].nAcked);
+    if ( Setpoints[i].bPending )
+      out.print(F(" pending"));
+    out.print(F(" writes="));
+    out.print(Setpoints[i].nWrites);
+    out.print(F(" retries="));
+    out.print(Setpoints[i].nRetries);
+    out.print(F(" rejected="));
+    out.print(Setpoints[i].nRejected);
+    out.print(F(" unknown="));
+    out.println(Setpoints[i].nUnknown);
+  }
+}
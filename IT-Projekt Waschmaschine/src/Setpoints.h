@@ -0,0 +1,149 @@
+/*! \page Setpoints Setpoint Shadow Registers
+Change driven setpoint writes.
+
+All setpoints of the plant, door state, drum speed, detergent and softener,
+are kept in shadow registers with the desired and the acknowledged value.
+A write "k=value" goes on the bus only if both differ or the acknowledge is missing,
+so an unchanged door state costs no I²C transaction at all.
+
+The plant echoes an assignment as "k=value", this is the acknowledge.
+Without an acknowledge, e.g. after a timeout, the write is repeated after SETPOINT_RETRY_MS.
+If the plant echoes a different value, e.g. a limited drum speed, that value is taken as acknowledged and counted as rejected.
+
+Dosing detergent or softener is an action rather than a state.
+Their setpoints are written once per Setpoint_Set() with bAlways and are never repeated after a plant reset.
+Nor are they repeated without acknowledge: after a timeout the plant may have dosed already,
+dosing twice is worse than once too little.
+Such a write is dropped and counted as unknown.
+*/
+
+#ifndef SETPOINTS_H
+#define SETPOINTS_H
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // setpoint attributes
+//! setpoints of the plant
+enum SetpointId
+{
+  SP_DOOR,                                      ///< "D=x" door closed
+  SP_DRUM,                                      ///< "r=n" drum speed
+  SP_DETERGENT,                                 ///< "O=n" dose detergent
+  SP_SOFTENER,                                  ///< "o=n" dose softener
+  SP_COUNT                                      ///< number of setpoints
+};
+
+//! min time between repeated writes without acknowledge in msec
+const unsigned long SETPOINT_RETRY_MS = 500;
+
+                                                // setpoint prototypes
+//! Set a desired value
+/*!
+Set the desired value of a setpoint.
+\param nId see SetpointId
+\param nValue desired value
+\param bAlways write even if the value equals the acknowledged one
+*/
+extern void Setpoint_Set(uint8_t nId, int nValue, bool bAlways = false);
+
+//! Get the desired value
+/*!
+Get the desired value of a setpoint.
+\param nId see SetpointId
+\return desired value
+*/
+extern int Setpoint_Desired(uint8_t nId);
+
+//! See if a setpoint is acknowledged
+/*!
+See if the plant has acknowledged the desired value of a setpoint.
+\param nId see SetpointId
+\return true if no write is pending
+*/
+extern bool Setpoint_IsAcked(uint8_t nId);
+
+//! Get the acknowledged value
+/*!
+Get the value the plant has acknowledged last.
+\param nId see SetpointId
+\return acknowledged value
+*/
+extern int Setpoint_Acked(uint8_t nId);
+
+//! Preset the acknowledged value
+/*!
+Take a value as acknowledged by the plant without writing it, e.g. from the state record a replay starts with.
+The setpoint stays pending if its desired value differs.
+\param nId see SetpointId
+\param nValue acknowledged value
+*/
+extern void Setpoint_Preset(uint8_t nId, int nValue);
+
+//! Find the setpoint of a command
+/*!
+Find the setpoint of an assignment "k=value".
+\param pszCommand command
+\return setpoint id, -1 if not a setpoint assignment
+*/
+extern int Setpoint_Find(const char * pszCommand);
+
+//! Find the next pending write
+/*!
+Find the setpoint Setpoint_Next() would write, without creating the write,
+e.g. to check for room in the queue at its priority first.
+\return setpoint id, -1 if no write is pending
+*/
+extern int Setpoint_Peek();
+
+//! Create the next pending write
+/*!
+Create the next pending write, in the order of SetpointId.
+The write counts as outstanding until Setpoint_Complete() is called, several setpoints may be outstanding.
+\param szCommand storage for the command, at least 16 bytes
+\return setpoint id, -1 if no write is pending
+*/
+extern int Setpoint_Next(char szCommand[]);
+
+//! Take back a write not sent
+/*!
+Take back the write just created by Setpoint_Next() if it could not be queued.
+It stays pending as before, it counts neither as write nor as missing acknowledge.
+\param nId see SetpointId
+*/
+extern void Setpoint_Withdraw(uint8_t nId);
+
+//! Complete a write
+/*!
+Complete the outstanding write of a setpoint, takes its acknowledge.
+To be called for the response and for the timeout of every write.
+\param nId see SetpointId
+\param pszResponse response, nullptr on timeout
+\return true if the response has been the acknowledge of the write
+*/
+extern bool Setpoint_Complete(uint8_t nId, const char * pszResponse);
+
+//! Complete a write with a value
+/*!
+Complete the outstanding write of a setpoint with an acknowledge already parsed, e.g. from a binary response.
+\param nId see SetpointId
+\param cKey key of the acknowledge, any other key counts as missing acknowledge
+\param nValue acknowledged value
+\return true if it has been the acknowledge of the write
+*/
+extern bool Setpoint_Acknowledge(uint8_t nId, char cKey, int nValue);
+
+//! Invalidate all acknowledges
+/*!
+Invalidate all acknowledges, e.g. after a plant reset, so the states are written again.
+*/
+extern void Setpoint_Invalidate();
+
+//! Print statistics
+/*!
+Print per setpoint: desired and acknowledged value, writes, retries, rejected writes and one shot writes without acknowledge.
+\param out output stream, typically Serial
+*/
+extern void Setpoint_PrintStats(Print & out);
+
+#endif // SETPOINTS_H
@@ -0,0 +1,118 @@
+/* Compact binary telemetry frames
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include telemetry
+#include "Telemetry.h"
+
+                                                // telemetry data
+//! frame interval in msec, 0 if off
+static unsigned int   msecFrameInterval = 0;
+//! time the last frame was due
+static unsigned long  msecLastFrame = 0;
+//! sequence number of the next frame
+static uint8_t        nSequence = 0;
+//! skipped frames
+static unsigned long  nFramesSkipped = 0;
+
+//! Update a CRC-16/CCITT-FALSE with one byte
+static uint16_t Crc16Update(uint16_t nCrc, uint8_t nByte)
+{
+  nCrc ^= (uint16_t)nByte << 8;
+  for ( int i = 0; i < 8; ++i )
+    nCrc = ( nCrc & 0x8000 ) ? ( nCrc << 1 ) ^ 0x1021 : ( nCrc << 1 );
+  return nCrc;
+}
+
+//! Store a value little endian
+/*!
+Store a value little endian.
+\param pFrame position in the frame
+\param nValue value
+\param nBytes value size in bytes
+\return position after the value
+*/
+static uint8_t * PutLE(uint8_t * pFrame, unsigned long nValue, int nBytes)
+{
+  for ( int i = 0; i < nBytes; ++i )
+  {
+    *pFrame++ = nValue & 0xFF;
+    nValue >>= 8;
+  }
+  return pFrame;
+}
+
+// Set frame rate
+void Telemetry_SetRate(unsigned int nHz)
+{
+  if ( nHz > TELEMETRY_RATE_MAX )
+    nHz = TELEMETRY_RATE_MAX;
+  msecFrameInterval = ( nHz == 0 ) ? 0 : 1000 / nHz;
+  msecLastFrame = millis();
+}
+
+// Get frame rate
+unsigned int Telemetry_Rate()
+{
+  return ( msecFrameInterval == 0 ) ? 0 : 1000 / msecFrameInterval;
+}
+
+// See if a frame is due
+bool Telemetry_Due()
+{
+  if ( msecFrameInterval == 0 )
+    return false;                               // off
+  unsigned long msecNow = millis();
+  if ( ( msecNow - msecLastFrame ) < msecFrameInterval )
+    return false;
+  msecLastFrame += msecFrameInterval;
+  if ( ( msecNow - msecLastFrame ) >= msecFrameInterval )
+    msecLastFrame = msecNow;                    // fell behind, no bursts
+  return true;
+}
+
+// Send a frame
+bool Telemetry_Send(HardwareSerial & out, const TelemetryData & data)
+{
+  if ( out.availableForWrite() < TELEMETRY_FRAME_SIZE )
+  {
+    ++nFramesSkipped;                           // would block
+    return false;
+  }
+
+  uint8_t   Frame[TELEMETRY_FRAME_SIZE];
+  uint8_t * p = Frame;
+  *p++ = 0xA5;                                  // sync
+  *p++ = 0x5A;
+  *p++ = TELEMETRY_PAYLOAD;
+  *p++ = TELEMETRY_VERSION;
+  *p++ = nSequence++;
+  p = PutLE(p, millis(), 4);
+  p = PutLE(p, data.nPlantTime, 4);
+  p = PutLE(p, (unsigned int)data.nTemperature, 2);
+  p = PutLE(p, data.nWaterLevel, 2);
+  p = PutLE(p, data.nWaterInLaundry, 2);
+  p = PutLE(p, (unsigned int)data.nRpm, 2);
+  *p++ = data.nLaundry;
+  *p++ = data.nDetergent;
+  p = PutLE(p, data.nWarnings, 2);
+  *p++ = data.nIOBits;
+  *p++ = data.nProgram;
+  *p++ = data.nStep;
+  p = PutLE(p, 0, 2);                           // reserved
+
+  uint16_t  nCrc = 0xFFFF;
+  for ( uint8_t * q = Frame + 2; q < p; ++q )
+    nCrc = Crc16Update(nCrc, *q);
+  p = PutLE(p, nCrc, 2);
+
+  out.write(Frame, p - Frame);
+  return true;
+}
+
+// Number of skipped frames
+unsigned long Telemetry_Skipped()
+{
+  return nFramesSkipped;
+}
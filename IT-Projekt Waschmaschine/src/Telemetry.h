@@ -0,0 +1,109 @@
+/*! \page Telemetry Binary Telemetry
+Compact binary telemetry frames.
+
+Instead of the ASCII output of ShowData() the controller can send fixed layout binary frames.
+A frame has 32 bytes and needs less than 3 msec at 115200 Baud.
+Frames are only written if the serial transmit buffer has room for a whole frame,
+so sending never blocks; otherwise the frame is skipped and counted.
+
+Frame layout, all values little endian:
+<table border="0" width="80%">
+<tr><td> 0  </td><td> 2 </td><td> sync 0xA5 0x5A </td></tr>
+<tr><td> 2  </td><td> 1 </td><td> payload length, TELEMETRY_PAYLOAD </td></tr>
+<tr><td> 3  </td><td> 1 </td><td> version, TELEMETRY_VERSION </td></tr>
+<tr><td> 4  </td><td> 1 </td><td> sequence number </td></tr>
+<tr><td> 5  </td><td> 4 </td><td> controller time in msec </td></tr>
+<tr><td> 9  </td><td> 4 </td><td> plant time in 0.01 min </td></tr>
+<tr><td> 13 </td><td> 2 </td><td> temperature in 0.01 °C, signed </td></tr>
+<tr><td> 15 </td><td> 2 </td><td> water level in g </td></tr>
+<tr><td> 17 </td><td> 2 </td><td> water in laundry in g </td></tr>
+<tr><td> 19 </td><td> 2 </td><td> drum rpm, signed </td></tr>
+<tr><td> 21 </td><td> 1 </td><td> laundry amount </td></tr>
+<tr><td> 22 </td><td> 1 </td><td> detergent amount </td></tr>
+<tr><td> 23 </td><td> 2 </td><td> warning bits </td></tr>
+<tr><td> 25 </td><td> 1 </td><td> IO bits, see TelemetryBits </td></tr>
+<tr><td> 26 </td><td> 1 </td><td> wash program </td></tr>
+<tr><td> 27 </td><td> 1 </td><td> wash program step </td></tr>
+<tr><td> 28 </td><td> 2 </td><td> reserved, 0 </td></tr>
+<tr><td> 30 </td><td> 2 </td><td> CRC-16/CCITT-FALSE over bytes 2..29 </td></tr>
+</table>
+
+The host side decoder is tools/telemetry_decode.py.
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // telemetry attributes
+//! frame layout version
+const uint8_t   TELEMETRY_VERSION = 1;
+//! payload length, version up to reserved bytes
+const uint8_t   TELEMETRY_PAYLOAD = 27;
+//! complete frame length
+const int       TELEMETRY_FRAME_SIZE = 2 + 1 + TELEMETRY_PAYLOAD + 2;
+//! max frame rate in Hz
+const unsigned int TELEMETRY_RATE_MAX = 50;
+
+//! IO bits
+enum TelemetryBits
+{
+  TM_WATER_INTAKE = 0x01,                       ///< water intake valve open
+  TM_WATER_PUMP   = 0x02,                       ///< water pump on
+  TM_HEATING      = 0x04,                       ///< heating on
+  TM_DOOR_CLOSED  = 0x08,                       ///< door closed
+  TM_RUNNING      = 0x10                        ///< wash program running
+};
+
+//! values to send, already scaled to integers
+struct TelemetryData
+{
+  unsigned long nPlantTime;                     ///< plant time in 0.01 min
+  int           nTemperature;                   ///< temperature in 0.01 °C
+  unsigned int  nWaterLevel;                    ///< water level in g
+  unsigned int  nWaterInLaundry;                ///< water in laundry in g
+  int           nRpm;                           ///< drum rpm
+  uint8_t       nLaundry;                       ///< laundry amount
+  uint8_t       nDetergent;                     ///< detergent amount
+  unsigned int  nWarnings;                      ///< warning bits
+  uint8_t       nIOBits;                        ///< see TelemetryBits
+  uint8_t       nProgram;                       ///< wash program
+  uint8_t       nStep;                          ///< wash program step
+};
+
+                                                // telemetry prototypes
+//! Set frame rate
+/*!
+Set frame rate.
+\param nHz frames per second, 0 switches binary telemetry off
+*/
+extern void Telemetry_SetRate(unsigned int nHz);
+
+//! Get frame rate
+/*!
+Get frame rate.
+\return frames per second, 0 if off
+*/
+extern unsigned int Telemetry_Rate();
+
+//! See if a frame is due
+/*!
+See if a frame is due, to be called at least at the frame rate.
+\return true if a frame should be sent now
+*/
+extern bool Telemetry_Due();
+
+//! Send a frame
+/*!
+Send a frame if the transmit buffer has room for it.
+\param out serial port
+\param data values to send
+\return true if sent, false if skipped
+*/
+extern bool Telemetry_Send(HardwareSerial & out, const TelemetryData & data);
+
+//! Number of skipped frames
+/*!
+Number of frames skipped because the transmit buffer was too full.
+\return skipped frames since start
+*/
+extern unsigned long Telemetry_Skipped();
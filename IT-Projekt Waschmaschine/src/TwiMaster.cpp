@@ -0,0 +1,243 @@
+/* Interrupt driven asynchronous TWI master
+*/
+
+// include standard Arduino library
+#include <Arduino.h>
+// include TWI master driver
+#include "TwiMaster.h"
+#if defined(__AVR__)
+// include TWI status codes
+#include <util/twi.h>
+#else
+// include standard I²C library
+#include <Wire.h>
+#endif
+
+                                                // TWI data
+//! slave address of the transfer
+static uint8_t            nSlaveAddress = 0;
+//! bytes to write
+static const uint8_t *    pWriteData = nullptr;
+//! number of bytes to write
+static volatile int       nWriteLength = 0;
+//! bytes written so far
+static volatile int       nWriteIndex = 0;
+//! receive buffer
+static uint8_t            ReadBuffer[TWI_BUFFER_MAX];
+//! number of bytes to read
+static volatile int       nReadLength = 0;
+//! bytes read so far
+static volatile int       nReadIndex = 0;
+//! status, see TwiStatus
+static volatile uint8_t   nStatus = TWI_IDLE;
+
+#if defined(__AVR__)
+//! TWCR bits to keep the interface enabled with interrupt
+#define TWCR_RUN          ( _BV(TWEN) | _BV(TWIE) | _BV(TWINT) )
+
+//! End a transfer with a stop condition
+static void Stop(uint8_t nResult)
+{
+  TWCR = TWCR_RUN | _BV(TWSTO);                 // stop, no interrupt follows
+  nStatus = nResult;
+}
+
+//! TWI interrupt, one state change of the bus
+ISR(TWI_vect)
+{
+  switch ( TW_STATUS )
+  {
+  case TW_START:
+  case TW_REP_START:
+    TWDR = ( nSlaveAddress << 1 ) | ( ( nWriteIndex < nWriteLength ) ? TW_WRITE : TW_READ );
+    TWCR = TWCR_RUN;
+    break;
+
+  case TW_MT_SLA_ACK:                           // write data
+  case TW_MT_DATA_ACK:
+    if ( nWriteIndex < nWriteLength )
+    {
+      TWDR = pWriteData[nWriteIndex++];
+      TWCR = TWCR_RUN;
+    }
+    else if ( nReadLength > 0 )
+      TWCR = TWCR_RUN | _BV(TWSTA);             // repeated start for reading
+    else
+      Stop(TWI_OK);
+    break;
+
+  case TW_MR_DATA_ACK:                          // read data
+    ReadBuffer[nReadIndex++] = TWDR;
+    // fall through
+  case TW_MR_SLA_ACK:
+    if ( nReadIndex + 1 < nReadLength )
+      TWCR = TWCR_RUN | _BV(TWEA);              // acknowledge, more to come
+    else
+      TWCR = TWCR_RUN;                          // no acknowledge for the last byte
+    break;
+
+  case TW_MR_DATA_NACK:                         // last byte
+    ReadBuffer[nReadIndex++] = TWDR;
+    Stop(TWI_OK);
+    break;
+
+  case TW_MT_SLA_NACK:
+  case TW_MT_DATA_NACK:
+  case TW_MR_SLA_NACK:
+    Stop(TWI_NACK);
+    break;
+
+  case TW_MT_ARB_LOST:                          // same as TW_MR_ARB_LOST
+    TWCR = TWCR_RUN;                            // release the bus
+    nStatus = TWI_ERROR;
+    break;
+
+  default:                                      // bus error
+    Stop(TWI_ERROR);
+    break;
+  }
+}
+#endif
+
+// TWI master setup
+void Twi_Setup(long nFrequency)
+{
+  nStatus = TWI_IDLE;
+#if defined(__AVR__)
+  digitalWrite(SDA, HIGH);                      // internal pull ups
+  digitalWrite(SCL, HIGH);
+  Twi_SetFrequency(nFrequency);
+  TWCR = _BV(TWEN) | _BV(TWIE);
+#else
+  Wire.begin();
+  Wire.setClock(nFrequency);
+#endif
+}
+
+// Set the bus frequency
+void Twi_SetFrequency(long nFrequency)
+{
+#if defined(__AVR__)
+  TWSR = 0;                                     // prescaler 1
+  TWBR = ( F_CPU / nFrequency - 16 ) / 2;       // set I²C speed
+#else
+  Wire.setClock(nFrequency);
+#endif
+}
+
+#if defined(__AVR__)
+//! Pull a bus line low
+static void PullLow(uint8_t nPin)
+{
+  digitalWrite(nPin, LOW);                      // pull up off, then drive low
+  pinMode(nPin, OUTPUT);
+}
+
+//! Release a bus line to its pull up
+static void Release(uint8_t nPin)
+{
+  pinMode(nPin, INPUT_PULLUP);
+  delayMicroseconds(5);                         // half a clock at 100 kHz
+}
+#endif
+
+// Free a hung bus
+int Twi_Recover()
+{
+  int   nResult = TWI_BUS_FREE;
+#if defined(__AVR__)
+  TWCR = 0;                                     // TWI off, the pins are ours
+  Release(SDA);
+  Release(SCL);
+  if ( digitalRead(SDA) == LOW )
+  {                                             // a slave is in the middle of a byte
+    nResult = TWI_BUS_RELEASED;
+    for ( int i = 0; ( i < TWI_RECOVER_CLOCKS ) && ( digitalRead(SDA) == LOW ); ++i )
+    {
+      PullLow(SCL);
+      delayMicroseconds(5);
+      Release(SCL);
+    }
+  }
+  PullLow(SDA);                                 // stop condition, SDA rises while SCL is high
+  delayMicroseconds(5);
+  Release(SDA);
+  if ( ( digitalRead(SDA) == LOW ) || ( digitalRead(SCL) == LOW ) )
+    nResult = TWI_BUS_STUCK;
+  TWCR = _BV(TWEN) | _BV(TWIE);                 // TWI takes the pins again, pull ups stay on
+#else
+  Wire.begin();
+#endif
+  nStatus = TWI_IDLE;
+  return nResult;
+}
+
+// Start a transfer
+bool Twi_Start(uint8_t nAddress, const uint8_t * pWrite, int nWrite, int nRead)
+{
+  if ( ( nStatus == TWI_BUSY ) || ( nStatus == TWI_STUCK ) )
+    return false;
+  if ( nRead > TWI_BUFFER_MAX )
+    nRead = TWI_BUFFER_MAX;
+  nSlaveAddress = nAddress;
+  pWriteData = pWrite;
+  nWriteLength = nWrite;
+  nWriteIndex = 0;
+  nReadLength = nRead;
+  nReadIndex = 0;
+  nStatus = TWI_BUSY;
+#if defined(__AVR__)
+  unsigned long usecStart = micros();
+  while ( TWCR & _BV(TWSTO) )
+  {                                             // previous stop still under way, some usec
+    if ( ( micros() - usecStart ) >= TWI_STOP_WAIT_US )
+    {
+      nStatus = TWI_STUCK;                      // SCL held low, up to the caller to recover
+      return false;
+    }
+  }
+  TWCR = TWCR_RUN | _BV(TWSTA);                 // start condition, the interrupt does the rest
+#else
+  uint8_t nResult = TWI_OK;
+  if ( nWrite > 0 )
+  {
+    Wire.beginTransmission(nAddress);
+    Wire.write(pWrite, nWrite);
+    if ( Wire.endTransmission(nRead == 0) != 0 )
+      nResult = TWI_NACK;
+  }
+  if ( ( nResult == TWI_OK ) && ( nRead > 0 ) )
+  {
+    Wire.requestFrom((int)nAddress, nRead);
+    while ( Wire.available() && ( nReadIndex < nRead ) )
+      ReadBuffer[nReadIndex++] = Wire.read();
+    if ( nReadIndex == 0 )
+      nResult = TWI_NACK;
+  }
+  nStatus = nResult;
+#endif
+  return true;
+}
+
+// Status of the last transfer
+uint8_t Twi_Status()
+{
+  return nStatus;
+}
+
+// Received bytes
+const uint8_t * Twi_Data(int * pnLength)
+{
+  *pnLength = nReadIndex;
+  return ReadBuffer;
+}
+
+// Abort a transfer
+void Twi_Abort()
+{
+#if defined(__AVR__)
+  TWCR = 0;                                     // reset the interface
+  TWCR = _BV(TWEN) | _BV(TWIE);
+#endif
+  nStatus = TWI_ERROR;
+}
@@ -0,0 +1,110 @@
+/*! \page TwiMaster TWI Master Driver
+Interrupt driven asynchronous TWI master.
+
+A transfer, write, repeated start and read, is started by Twi_Start() and runs completely in the TWI interrupt.
+The caller polls Twi_Status() until it is no longer TWI_BUSY, nothing ever waits on the bus.
+Received bytes are kept in a static buffer of TWI_BUFFER_MAX bytes.
+
+Status codes:
+<table border="0" width="80%">
+<tr><td> TWI_IDLE  </td><td> no transfer since setup </td></tr>
+<tr><td> TWI_BUSY  </td><td> transfer under way </td></tr>
+<tr><td> TWI_OK    </td><td> transfer complete </td></tr>
+<tr><td> TWI_NACK  </td><td> slave did not acknowledge its address or data </td></tr>
+<tr><td> TWI_ERROR </td><td> arbitration lost, bus error or aborted </td></tr>
+<tr><td> TWI_STUCK </td><td> stop of the previous transfer not complete, SCL held low </td></tr>
+</table>
+
+Twi_Recover() frees a bus hung by a slave holding SDA low, e.g. after a reset of the master in the middle of a read.
+It clocks SCL by hand until the slave releases SDA, at most 9 times, and ends with a stop condition.
+
+Only AVR has the register level driver.
+Other targets run the transfer with the Wire library at once, it is complete when Twi_Start() returns.
+*/
+
+#ifndef TWI_MASTER_H
+#define TWI_MASTER_H
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // TWI attributes
+//! max bytes per read
+const int       TWI_BUFFER_MAX = 32;
+
+//! max SCL pulses to free a hung bus, one byte and its acknowledge
+const int       TWI_RECOVER_CLOCKS = 9;
+
+//! max wait for the stop of the previous transfer in usec, some bits at 100 kHz
+const unsigned long TWI_STOP_WAIT_US = 100;
+
+//! transfer status
+enum TwiStatus { TWI_IDLE, TWI_BUSY, TWI_OK, TWI_NACK, TWI_ERROR, TWI_STUCK };
+
+//! result of a bus recovery
+enum TwiRecovery
+{
+  TWI_BUS_FREE = 0,                             ///< bus has been free
+  TWI_BUS_RELEASED = 1,                         ///< a slave held SDA low and released it
+  TWI_BUS_STUCK = -1                            ///< SDA or SCL still held low
+};
+
+                                                // TWI prototypes
+//! TWI master setup
+/*!
+TWI master setup.
+\param nFrequency bus frequency in Hz
+*/
+extern void Twi_Setup(long nFrequency);
+
+//! Set the bus frequency
+/*!
+Set the bus frequency, to be called between transfers only.
+\param nFrequency bus frequency in Hz, e.g. 100000 or 400000
+*/
+extern void Twi_SetFrequency(long nFrequency);
+
+//! Free a hung bus
+/*!
+Free a bus hung by a slave, blocks for at most about 100 usec.
+Aborts a transfer under way.
+\return see TwiRecovery
+*/
+extern int Twi_Recover();
+
+//! Start a transfer
+/*!
+Start a transfer: write nWrite bytes, then with a repeated start read nRead bytes.
+Either part may be empty.
+Waits up to TWI_STOP_WAIT_US for the stop of the previous transfer,
+if it does not complete a slave holds SCL low and the status is TWI_STUCK until Twi_Recover().
+\param nAddress slave address
+\param pWrite bytes to write, have to remain unchanged until the transfer is complete
+\param nWrite number of bytes to write
+\param nRead number of bytes to read, at most TWI_BUFFER_MAX
+\return false if busy or stuck
+*/
+extern bool Twi_Start(uint8_t nAddress, const uint8_t * pWrite, int nWrite, int nRead);
+
+//! Status of the last transfer
+/*!
+Status of the last transfer.
+\return see TwiStatus
+*/
+extern uint8_t Twi_Status();
+
+//! Received bytes
+/*!
+Received bytes of the last transfer, valid once it is no longer TWI_BUSY.
+\param pnLength storage for the number of bytes received
+\return receive buffer
+*/
+extern const uint8_t * Twi_Data(int * pnLength);
+
+//! Abort a transfer
+/*!
+Abort a transfer, e.g. on timeout, and release the bus.
+*/
+extern void Twi_Abort();
+
+#endif // TWI_MASTER_H
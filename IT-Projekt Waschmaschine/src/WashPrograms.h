@@ -0,0 +1,114 @@
+/*! \page WashPrograms Wash Programs
+Wash programs as step tables.
+
+Each program is a list of steps stored in flash (PROGMEM).
+The steps are executed one after the other by the wash program interpreter in Controller.ino.
+A new program only costs 4 bytes of flash per step, no code and no SRAM.
+
+<table border="0" width="80%">
+<tr><td> WS_FILL   </td><td> fill water up to nValue/10 kg </td></tr>
+<tr><td> WS_HEAT   </td><td> heat up to nValue °C, the temperature is held until the next drain </td></tr>
+<tr><td> WS_TUMBLE </td><td> drum nValue rpm, toggled on/off every nArg sec until the next drain </td></tr>
+<tr><td> WS_HOLD   </td><td> wait nValue sec, heating and tumbling go on </td></tr>
+<tr><td> WS_DOSE   </td><td> add nValue of detergent (nArg = 'O') or softener (nArg = 'o') </td></tr>
+<tr><td> WS_DRAIN  </td><td> pump water out, at most nValue sec </td></tr>
+<tr><td> WS_SPIN   </td><td> spin with nValue rpm for nArg sec, pump on </td></tr>
+<tr><td> WS_END    </td><td> program end </td></tr>
+</table>
+
+Phase overlap, on by default, "So=0" runs the steps strictly one after the other:
+- While filling, as soon as the water level passes WASH_LEVEL_OVERLAP safely above the heater,
+  the heating of the next WS_HEAT starts and the next WS_DOSE steps are dosed,
+  both up to the next step changing the water, WS_FILL, WS_DRAIN or WS_SPIN.
+  Steps dosed ahead are skipped later.
+- While draining with a WS_SPIN next, the spin starts once the water level is below WASH_LEVEL_SPIN,
+  the time spun counts for the WS_SPIN step.
+
+The time heated or spun ahead is printed at the end of the program and shown by "S?".
+It is not the time saved, the heater may run ahead while the program waits for the water anyway.
+The saving is measured against the same program with "So=0".
+
+Program 1 is the former hardcoded wash program.
+The steps of programs 2 and 3 are not taken from any source:
+the steuerung table of the web interface only holds which program is selected (prog1, prog2, prog3),
+so their temperatures, times and speeds are plausible defaults to be replaced by real ones.
+*/
+
+#ifndef WASHPROGRAMS_H
+#define WASHPROGRAMS_H
+
+// include standard Arduino library
+#include <Arduino.h>
+
+                                                // wash program steps
+//! step operations
+enum WashOp { WS_END, WS_FILL, WS_HEAT, WS_TUMBLE, WS_HOLD, WS_DOSE, WS_DRAIN, WS_SPIN };
+
+//! one step of a wash program, 4 bytes in flash
+struct WashStepDef
+{
+  uint8_t       nOp;                            ///< operation, see WashOp
+  uint8_t       nArg;                           ///< small argument, meaning depends on nOp
+  uint16_t      nValue;                         ///< main argument, meaning depends on nOp
+};
+
+//! water level in g above which heating and dosing may start while filling, safely above the heater
+const int       WASH_LEVEL_OVERLAP = 800;
+//! water level in g below which the spin may start while draining
+const int       WASH_LEVEL_SPIN = 1000;
+//! max steps per program which can be done ahead, one bit each
+const int       WASH_STEPS_AHEAD_MAX = 32;
+
+                                                // wash programs
+//! program 1, 60°C
+const WashStepDef WashProg1[] PROGMEM =
+{
+  { WS_FILL,   0,   13 },                       // 1.3 kg water
+  { WS_DOSE,   'O', 3 },                        // Waschpulver
+  { WS_HEAT,   0,   60 },                       // 60°C
+  { WS_TUMBLE, 5,   800 },                      // 800 rpm, 5 sec on, 5 sec off
+  { WS_HOLD,   0,   60 },                       // wash 1 min
+  { WS_DRAIN,  0,   5 },
+  { WS_END,    0,   0 }
+};
+
+//! program 2, 40°C with rinse, made up defaults
+const WashStepDef WashProg2[] PROGMEM =
+{
+  { WS_FILL,   0,   13 },
+  { WS_DOSE,   'O', 2 },
+  { WS_HEAT,   0,   40 },
+  { WS_TUMBLE, 5,   600 },
+  { WS_HOLD,   0,   60 },
+  { WS_DRAIN,  0,   5 },
+  { WS_FILL,   0,   10 },                       // rinse
+  { WS_DOSE,   'o', 2 },                        // Weichspüler
+  { WS_TUMBLE, 3,   600 },
+  { WS_HOLD,   0,   30 },
+  { WS_DRAIN,  0,   5 },
+  { WS_SPIN,   20,  1200 },                     // 1200 rpm for 20 sec
+  { WS_END,    0,   0 }
+};
+
+//! program 3, cold with rinse, made up defaults
+const WashStepDef WashProg3[] PROGMEM =
+{
+  { WS_FILL,   0,   13 },
+  { WS_DOSE,   'O', 2 },
+  { WS_TUMBLE, 5,   400 },
+  { WS_HOLD,   0,   45 },
+  { WS_DRAIN,  0,   5 },
+  { WS_FILL,   0,   10 },
+  { WS_DOSE,   'o', 2 },
+  { WS_HOLD,   0,   20 },
+  { WS_DRAIN,  0,   5 },
+  { WS_SPIN,   20,  800 },
+  { WS_END,    0,   0 }
+};
+
+//! all programs, program number n is at index n-1
+const WashStepDef * const WashPrograms[] PROGMEM = { WashProg1, WashProg2, WashProg3 };
+//! number of programs
+const int       WASH_PROGRAM_COUNT = sizeof(WashPrograms) / sizeof(WashPrograms[0]);
+
+#endif // WASHPROGRAMS_H
@@ -0,0 +1,92 @@
+/* Unit tests of the binary plant protocol, pio test -e native
+*/
+
+// include Arduino HAL shim
+#include <Arduino.h>
+// include binary protocol
+#include "BinaryProtocol.h"
+// include unit test framework
+#include <unity.h>
+
+void setUp() { }
+void tearDown() { }
+
+//! Value of a single entry frame
+static long EntryValue(const uint8_t * pFrame, int nLength, char cExpectedId)
+{
+  char          cId = 0;
+  long          nValue = 12345;
+  TEST_ASSERT_EQUAL(0, Binary_Next(pFrame, nLength, Binary_Next(pFrame, nLength, 1, &cId, &nValue), &cId, &nValue));
+  TEST_ASSERT_EQUAL(cExpectedId, cId);
+  return nValue;
+}
+
+//! Reads and writes of an ASCII request
+void test_from_text()
+{
+  static const uint8_t Expected[] = { 0xB1, 'T', 0, 'C', 0, 'r', 2, 0x20, 0x03 };
+  uint8_t       Frame[16];
+  int           nLength = Binary_FromText("T?C?r=800", Frame, sizeof(Frame));
+  TEST_ASSERT_EQUAL(sizeof(Expected), nLength);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(Expected, Frame, sizeof(Expected));
+  TEST_ASSERT_EQUAL(1, Binary_Version(Frame, nLength));
+}
+
+//! Requests staying ASCII
+void test_from_text_refused()
+{
+  uint8_t       Frame[4];
+  TEST_ASSERT_EQUAL(-1, Binary_FromText("R", Frame, sizeof(Frame)));
+  TEST_ASSERT_EQUAL(-1, Binary_FromText("r=x", Frame, sizeof(Frame)));
+  TEST_ASSERT_EQUAL(-1, Binary_FromText("r=800", Frame, sizeof(Frame))); // does not fit
+}
+
+//! A negative write is sent in 2 bytes and read back with its sign
+void test_negative_write()
+{
+  uint8_t       Frame[8];
+  int           nLength = Binary_FromText("C=-100", Frame, sizeof(Frame));
+  TEST_ASSERT_EQUAL(5, nLength);
+  TEST_ASSERT_EQUAL_HEX8(0x9C, Frame[3]);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, Frame[4]);
+  TEST_ASSERT_EQUAL(-100, EntryValue(Frame, nLength, 'C'));
+}
+
+//! Sign extension of every value size
+void test_sign_extension()
+{
+  static const uint8_t Byte[] = { 0xB1, 'D', 1, 0x80 };
+  static const uint8_t Word[] = { 0xB1, 'C', 2, 0x00, 0x80 };
+  static const uint8_t WordMax[] = { 0xB1, 'C', 2, 0xFF, 0x7F };
+  static const uint8_t Long[] = { 0xB1, 'T', 4, 0xFE, 0xFF, 0xFF, 0xFF };
+  static const uint8_t LongMin[] = { 0xB1, 'T', 4, 0x00, 0x00, 0x00, 0x80 };
+  static const uint8_t Read[] = { 0xB1, 'C', 0 };
+  TEST_ASSERT_EQUAL(-128, EntryValue(Byte, sizeof(Byte), 'D'));
+  TEST_ASSERT_EQUAL(-32768, EntryValue(Word, sizeof(Word), 'C'));
+  TEST_ASSERT_EQUAL(32767, EntryValue(WordMax, sizeof(WordMax), 'C'));
+  TEST_ASSERT_EQUAL(-2, EntryValue(Long, sizeof(Long), 'T'));
+  TEST_ASSERT_EQUAL(-2147483647L - 1, EntryValue(LongMin, sizeof(LongMin), 'T'));
+  TEST_ASSERT_EQUAL(0, EntryValue(Read, sizeof(Read), 'C'));
+}
+
+//! Unknown sizes are skipped, truncated entries reported
+void test_skip_and_truncated()
+{
+  static const uint8_t Unknown[] = { 0xB1, 'X', 3, 1, 2, 3, 'C', 1, 0x05 };
+  static const uint8_t Truncated[] = { 0xB1, 'C', 2, 0x05 };
+  char          cId = 0;
+  long          nValue = 0;
+  TEST_ASSERT_EQUAL(5, EntryValue(Unknown, sizeof(Unknown), 'C'));
+  TEST_ASSERT_EQUAL(-1, Binary_Next(Truncated, sizeof(Truncated), 1, &cId, &nValue));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_from_text);
+  RUN_TEST(test_from_text_refused);
+  RUN_TEST(test_negative_write);
+  RUN_TEST(test_sign_extension);
+  RUN_TEST(test_skip_and_truncated);
+  return UNITY_END();
+}
@@ -0,0 +1,91 @@
+/* Unit tests of the fixed point values, pio test -e native
+*/
+
+// include Arduino HAL shim
+#include <Arduino.h>
+// include fixed point values
+#include "FixedPoint.h"
+// include unit test framework
+#include <unity.h>
+
+//! Print into a string
+class StringPrint : public Print
+{
+public:
+  std::string   text;                           ///< printed so far
+  size_t write(uint8_t c) override { text += (char)c; return 1; }
+  using Print::write;
+};
+
+//! Value printed by PrintFixed()
+static std::string Printed(long nValue, uint8_t nDecimals)
+{
+  StringPrint out;
+  PrintFixed(out, nValue, nDecimals);
+  return out.text;
+}
+
+void setUp() { }
+void tearDown() { }
+
+//! Typical plant values
+void test_parse_values()
+{
+  TEST_ASSERT_EQUAL(2345, ParseFixed("23.45", 2));
+  TEST_ASSERT_EQUAL(1300, ParseFixed("1.300", 3));
+  TEST_ASSERT_EQUAL(6020, ParseFixed("60.2", 2));
+  TEST_ASSERT_EQUAL(5, ParseFixed("0.05", 2));
+  TEST_ASSERT_EQUAL(600, ParseFixed("60", 1));
+}
+
+//! Digits beyond the decimals are rounded by the first one dropped
+void test_parse_rounding()
+{
+  TEST_ASSERT_EQUAL(2346, ParseFixed("23.456", 2));
+  TEST_ASSERT_EQUAL(2345, ParseFixed("23.454", 2));
+  TEST_ASSERT_EQUAL(11837, ParseFixed("118.37", 2));
+  TEST_ASSERT_EQUAL(24, ParseFixed("23.5", 0));
+}
+
+//! Blanks, signs and the end of the number
+void test_parse_sign_and_end()
+{
+  TEST_ASSERT_EQUAL(-130, ParseFixed(" -1.3", 2));
+  TEST_ASSERT_EQUAL(130, ParseFixed("+1.3", 2));
+  TEST_ASSERT_EQUAL(-1, ParseFixed("-0.005", 2));
+  TEST_ASSERT_EQUAL(2345, ParseFixed("23.45C=1", 2));
+  TEST_ASSERT_EQUAL(0, ParseFixed("abc", 2));
+  TEST_ASSERT_EQUAL(0, ParseFixed("", 2));
+}
+
+//! Fraction with leading zeros, no decimals, negative values
+void test_print()
+{
+  TEST_ASSERT_EQUAL_STRING("23.45", Printed(2345, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("0.05", Printed(5, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("1.00", Printed(100, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("1.300", Printed(1300, 3).c_str());
+  TEST_ASSERT_EQUAL_STRING("-1.30", Printed(-130, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("600", Printed(600, 0).c_str());
+  TEST_ASSERT_EQUAL_STRING("0.0", Printed(0, 1).c_str());
+}
+
+//! Printed values parse back to the same value
+void test_round_trip()
+{
+  static const long Values[] = { 0, 7, -7, 99, 100, 2345, -2345, 100001 };
+  for ( long nValue : Values )
+    for ( uint8_t nDecimals = 0; nDecimals <= 3; ++nDecimals )
+      TEST_ASSERT_EQUAL(nValue, ParseFixed(Printed(nValue, nDecimals).c_str(), nDecimals));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_values);
+  RUN_TEST(test_parse_rounding);
+  RUN_TEST(test_parse_sign_and_end);
+  RUN_TEST(test_print);
+  RUN_TEST(test_round_trip);
+  return UNITY_END();
+}
@@ -0,0 +1,114 @@
+/* Unit tests of the scheduler, pio test -e native
+*/
+
+// include Arduino HAL shim
+#include <Arduino.h>
+// include native simulation control
+#include "Native.h"
+// include scheduler
+#include "Scheduler.h"
+// include unit test framework
+#include <unity.h>
+
+//! Print into a string
+class StringPrint : public Print
+{
+public:
+  std::string   text;                           ///< printed so far
+  size_t write(uint8_t c) override { text += (char)c; return 1; }
+  using Print::write;
+};
+
+                                                // test data
+//! runs of the task
+static int            nRuns = 0;
+//! simulated time of the runs in usec
+static unsigned long  RunTimes[16];
+
+//! Task counting its runs
+static void CountRun()
+{
+  if ( nRuns < 16 )
+    RunTimes[nRuns] = micros();
+  ++nRuns;
+}
+
+//! Tasks run by the tests, 10 msec period each
+static const SchedTask CatchUpTask[] = { { CountRun, "catch up", 10, 0, 1, SCHED_CATCH_UP } };
+static const SchedTask SkipTask[] = { { CountRun, "skip", 10, 0, 1, SCHED_SKIP } };
+
+//! Run all due tasks
+static int RunDue()
+{
+  int           nStarted = 0;
+  while ( Scheduler_Run() >= 0 )
+    ++nStarted;
+  return nStarted;
+}
+
+//! Statistics line of the only task
+static std::string Stats()
+{
+  StringPrint out;
+  Scheduler_PrintStats(out);
+  return out.text;
+}
+
+void setUp()
+{
+  nRuns = 0;
+}
+
+void tearDown() { }
+
+//! In time the task runs once per period
+void test_in_time()
+{
+  Scheduler_Setup(CatchUpTask);
+  for ( int i = 0; i < 5; ++i )
+  {
+    TEST_ASSERT_EQUAL(1, RunDue());
+    Native_Advance(10000);
+  }
+  TEST_ASSERT_EQUAL(5, nRuns);
+  TEST_ASSERT_EQUAL_STRING("# catch up runs=5 overruns=0 dropped=0 jitter=0\r\n", Stats().c_str());
+}
+
+//! 55 msec late: SCHED_CATCH_UP_MAX missed activations back to back, the rest dropped
+void test_catch_up()
+{
+  Scheduler_Setup(CatchUpTask);
+  unsigned long usecStart = micros();
+  Native_Advance(55000);
+  TEST_ASSERT_EQUAL(1 + SCHED_CATCH_UP_MAX, RunDue());
+  TEST_ASSERT_EQUAL_STRING("# catch up runs=4 overruns=1 dropped=2 jitter=55000\r\n", Stats().c_str());
+  for ( int i = 0; i < nRuns; ++i )
+    TEST_ASSERT_EQUAL(usecStart + 55000, RunTimes[i]);
+
+  Native_Advance(5000);                         // back on the grid, 60 msec after the start
+  TEST_ASSERT_EQUAL(1, RunDue());
+  Native_Advance(9999);
+  TEST_ASSERT_EQUAL(0, RunDue());
+  Native_Advance(1);
+  TEST_ASSERT_EQUAL(1, RunDue());
+}
+
+//! 55 msec late: SCHED_SKIP runs once and drops all missed activations
+void test_skip()
+{
+  Scheduler_Setup(SkipTask);
+  Native_Advance(55000);
+  TEST_ASSERT_EQUAL(1, RunDue());
+  TEST_ASSERT_EQUAL_STRING("# skip runs=1 overruns=1 dropped=5 jitter=55000\r\n", Stats().c_str());
+  Native_Advance(5000);
+  TEST_ASSERT_EQUAL(1, RunDue());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_in_time);
+  RUN_TEST(test_catch_up);
+  RUN_TEST(test_skip);
+  return UNITY_END();
+}
@@ -0,0 +1,94 @@
+/* Unit tests of the binary telemetry frames, pio test -e native
+*/
+
+// include Arduino HAL shim
+#include <Arduino.h>
+// include binary telemetry
+#include "Telemetry.h"
+// include unit test framework
+#include <unity.h>
+
+//! Serial port keeping the frames written
+class CaptureSerial : public HardwareSerial
+{
+public:
+  std::string   bytes;                          ///< written so far
+  size_t write(uint8_t c) override { bytes += (char)c; return 1; }
+  size_t write(const uint8_t * pData, size_t nLength) override
+  {
+    bytes.append((const char *)pData, nLength);
+    return nLength;
+  }
+  using Print::write;
+};
+
+//! CRC-16/CCITT-FALSE bit by bit, the reference of tools/serial_frames.py
+static uint16_t ReferenceCrc(const uint8_t * pData, size_t nLength)
+{
+  uint16_t      nCrc = 0xFFFF;
+  for ( size_t i = 0; i < nLength; ++i )
+  {
+    nCrc ^= (uint16_t)pData[i] << 8;
+    for ( int nBit = 0; nBit < 8; ++nBit )
+      nCrc = ( nCrc & 0x8000 ) ? ( nCrc << 1 ) ^ 0x1021 : ( nCrc << 1 );
+  }
+  return nCrc;
+}
+
+//! A frame of typical values
+static std::string SendFrame()
+{
+  TelemetryData data = {};
+  data.nPlantTime = 6000;
+  data.nTemperature = -1300;
+  data.nWaterLevel = 1000;
+  data.nRpm = 800;
+  data.nIOBits = TM_DOOR_CLOSED | TM_RUNNING;
+  CaptureSerial out;
+  TEST_ASSERT_TRUE(Telemetry_Send(out, data));
+  return out.bytes;
+}
+
+void setUp() { }
+void tearDown() { }
+
+//! The reference itself, the check value of the CRC catalogue
+void test_reference_check_value()
+{
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, ReferenceCrc((const uint8_t *)"123456789", 9));
+}
+
+//! Layout and CRC of a frame
+void test_frame_crc()
+{
+  std::string   frame = SendFrame();
+  const uint8_t * p = (const uint8_t *)frame.data();
+  TEST_ASSERT_EQUAL(TELEMETRY_FRAME_SIZE, frame.size());
+  TEST_ASSERT_EQUAL_HEX8(0xA5, p[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x5A, p[1]);
+  TEST_ASSERT_EQUAL(TELEMETRY_PAYLOAD, p[2]);
+  TEST_ASSERT_EQUAL(TELEMETRY_VERSION, p[3]);
+  uint16_t      nCrc = p[TELEMETRY_FRAME_SIZE-2] | ( p[TELEMETRY_FRAME_SIZE-1] << 8 );
+  TEST_ASSERT_EQUAL_HEX16(ReferenceCrc(p + 2, TELEMETRY_FRAME_SIZE - 4), nCrc);
+}
+
+//! Every frame has its own sequence number and CRC
+void test_sequence_changes_crc()
+{
+  std::string   first = SendFrame();
+  std::string   second = SendFrame();
+  TEST_ASSERT_EQUAL((uint8_t)( first[4] + 1 ), (uint8_t)second[4]);
+  const uint8_t * p = (const uint8_t *)second.data();
+  uint16_t      nCrc = p[TELEMETRY_FRAME_SIZE-2] | ( p[TELEMETRY_FRAME_SIZE-1] << 8 );
+  TEST_ASSERT_EQUAL_HEX16(ReferenceCrc(p + 2, TELEMETRY_FRAME_SIZE - 4), nCrc);
+  TEST_ASSERT_TRUE(first.substr(TELEMETRY_FRAME_SIZE - 2) != second.substr(TELEMETRY_FRAME_SIZE - 2));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_reference_check_value);
+  RUN_TEST(test_frame_crc);
+  RUN_TEST(test_sequence_changes_crc);
+  return UNITY_END();
+}
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""Capture tool for the I2C transaction records of the washing machine controller.
+
+Reads the controller output from a serial port (needs pyserial) or from a
+captured file, after "c=1" has been typed on the controller.
+Every valid record is written unchanged to the log, if given, for a replay
+by the native build, and printed as one line:
+
+  seq usec slave tag result response_usec request -> response
+
+A slave without length prefix is marked with a '*' after its number.
+The state record the recording starts with, slave 0, is printed as
+
+  seq usec state legacy=<slaves without length prefix> <state of the controller>
+
+with both in hex.
+
+Text lines and telemetry frames between the records go to stderr.
+The record layout is documented in src/I2C_Master.h.
+
+Examples:
+  i2c_capture.py /dev/ttyACM0 field.log       # live, 115200 Baud
+  i2c_capture.py output.bin field.log         # captured stream
+  i2c_capture.py field.log                    # show a log
+"""
+
+import struct
+import sys
+
+from serial_frames import FrameDecoder, crc16_ccitt
+
+SYNC = b"\xa5\xc3"
+VERSION = 1
+HEADER = struct.Struct("<BBBIBBbIB")            # length .. request length
+TAIL = 2                                        # CRC
+
+
+class Decoder(FrameDecoder):
+    """I2C transaction records, counts CRC errors and lost records."""
+
+    SYNC = SYNC
+    KIND = "record"
+
+    def __init__(self):
+        super().__init__()
+        self.last_seq = None
+        self.lost = 0
+
+    def frame_size(self):
+        if len(self.buffer) < 3:
+            return None
+        return 2 + 1 + self.buffer[2] + TAIL
+
+    def check(self, raw):
+        body, crc = raw[2:-2], struct.unpack("<H", raw[-2:])[0]
+        if len(body) < HEADER.size or body[1] != VERSION or crc16_ccitt(body) != crc:
+            return None
+        fields = HEADER.unpack(body[:HEADER.size])
+        request = body[HEADER.size:HEADER.size + fields[8]]
+        response = body[HEADER.size + fields[8]:]
+        seq = fields[2]
+        if self.last_seq is not None:
+            self.lost += (seq - self.last_seq - 1) & 0xFF
+        self.last_seq = seq
+        return raw, (fields, request, response)
+
+
+def printable(data):
+    """Bytes as text, not printable ones as \\xHH, as the trace of the controller."""
+    return "".join(chr(b) if 0x20 <= b < 0x7F else "\\x%02X" % b for b in data)
+
+
+def format_record(item):
+    (_, _, seq, usec, slave, tag, result, response_usec, _), request, response = item
+    if slave == 0:
+        return "%d %d state legacy=%s %s" % (seq, usec, request.hex(), response.hex())
+    answer = "timeout" if result < 0 else printable(response)
+    return "%d %d %d%s 0x%02X %d %d %s -> %s" % (
+        seq, usec, slave & 0x7F, "*" if slave & 0x80 else "", tag, result, response_usec,
+        printable(request), answer)
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+    source = argv[1]
+    if source.startswith("/dev/") or source.upper().startswith("COM"):
+        import serial                               # pyserial
+        stream = serial.Serial(source, 115200, timeout=0.1)
+        read = lambda: stream.read(256)
+    else:
+        stream = open(source, "rb")
+        read = lambda: stream.read(4096) or None
+    log = open(argv[2], "wb") if len(argv) == 3 else None
+
+    decoder = Decoder()
+    records = 0
+    try:
+        while True:
+            data = read()
+            if data is None:
+                break
+            for kind, *item in decoder.feed(data):
+                if kind == "record":
+                    raw, fields = item
+                    records += 1
+                    if log:
+                        log.write(raw)
+                        log.flush()
+                    print(format_record(fields), flush=True)
+                else:
+                    print(item[0], file=sys.stderr)
+    except KeyboardInterrupt:
+        pass
+    print("# records %d, crc errors %d, lost records %d, garbage bytes %d"
+          % (records, decoder.crc_errors, decoder.lost, decoder.garbage), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
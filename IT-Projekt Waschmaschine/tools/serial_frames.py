@@ -0,0 +1,87 @@
+"""Splitting of the controller output into binary frames and text lines.
+
+Shared by telemetry_decode.py and i2c_capture.py.
+A frame starts with a two byte sync, everything else is taken as text lines.
+Bytes before a sync which do not end a text line are dropped as garbage,
+e.g. the rest of a damaged frame or a stray byte, and counted.
+A frame with a bad CRC is counted and the search goes on behind its sync.
+"""
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE as computed by the controller."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class FrameDecoder:
+    """Base of the decoders, splits a byte stream into frames and text lines.
+
+    Subclasses set SYNC and KIND and implement frame_size() and check().
+    """
+
+    SYNC = b""
+    KIND = "frame"
+    TEXT_MAX = 256                                  # longer text without line end is garbage
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.crc_errors = 0
+        self.garbage = 0
+
+    def frame_size(self):
+        """Size of the frame at the start of the buffer, None while unknown."""
+        raise NotImplementedError
+
+    def check(self, raw):
+        """Items of a valid frame as tuple, None if it is damaged."""
+        raise NotImplementedError
+
+    def feed(self, data):
+        """Add received bytes, yield (KIND, items...) per frame or ('text', line)."""
+        self.buffer += data
+        while True:
+            pos = self.buffer.find(self.SYNC)
+            if pos < 0:
+                yield from self._text(len(self.buffer), False)  # a partial sync stays with the rest
+                return
+            if pos > 0:
+                yield from self._text(pos, True)    # now the sync is at the start
+                continue
+            size = self.frame_size()
+            if size is None or len(self.buffer) < size:
+                return
+            raw = bytes(self.buffer[:size])
+            items = self.check(raw)
+            if items is None:
+                self.crc_errors += 1
+                del self.buffer[:1]                 # resync behind this sync
+                continue
+            del self.buffer[:size]
+            yield (self.KIND,) + items
+
+    def _text(self, end, drop):
+        """Move complete text lines before position end out of the buffer.
+
+        With drop the rest before end is dropped as garbage, else it is kept
+        for more bytes unless it is longer than TEXT_MAX.
+        """
+        while True:
+            nl = self.buffer.find(b"\n", 0, max(end, 0))
+            if nl < 0:
+                if not drop and end > self.TEXT_MAX:
+                    end -= len(self.SYNC) - 1       # may be the start of a sync
+                elif not drop:
+                    return
+                self.garbage += max(end, 0)
+                del self.buffer[:max(end, 0)]
+                return
+            line = bytes(self.buffer[:nl]).decode("latin-1").strip()
+            del self.buffer[:nl + 1]
+            end -= nl + 1
+            if line:
+                yield "text", line
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Decoder for the binary telemetry frames of the washing machine controller.
+
+Reads the controller output from a serial port (needs pyserial) or from a
+captured file and prints one line per valid frame, columns separated by
+blanks for gnuplot:
+
+  msec seq time[min] C[degC] A[kg] w[kg] rpm L O W intake pump heating door running prog step
+
+Text lines between the frames (banner, '#' messages) go to stderr.
+The frame layout is documented in src/Telemetry.h.
+
+Examples:
+  telemetry_decode.py /dev/ttyACM0            # live, 115200 Baud
+  telemetry_decode.py capture.bin > w.dat     # captured stream
+"""
+
+import struct
+import sys
+
+from serial_frames import FrameDecoder, crc16_ccitt
+
+SYNC = b"\xa5\x5a"
+VERSION = 1
+PAYLOAD = 27
+FRAME_SIZE = 2 + 1 + PAYLOAD + 2
+LAYOUT = struct.Struct("<BBBIIhHHhBBHBBBH")      # length .. reserved, CRC follows
+
+
+class Decoder(FrameDecoder):
+    """Telemetry frames, counts CRC errors and lost frames."""
+
+    SYNC = SYNC
+    KIND = "frame"
+
+    def __init__(self):
+        super().__init__()
+        self.last_seq = None
+        self.lost = 0
+
+    def frame_size(self):
+        return FRAME_SIZE
+
+    def check(self, raw):
+        body, crc = raw[2:-2], struct.unpack("<H", raw[-2:])[0]
+        if body[0] != PAYLOAD or body[1] != VERSION or crc16_ccitt(body) != crc:
+            return None
+        values = LAYOUT.unpack(body)
+        seq = values[2]
+        if self.last_seq is not None:
+            self.lost += (seq - self.last_seq - 1) & 0xFF
+        self.last_seq = seq
+        return (values,)
+
+
+def format_frame(values):
+    (_, _, seq, msec, ptime, temp, level, wil, rpm,
+     laundry, detergent, warnings, io, prog, step, _) = values
+    bits = [(io >> n) & 1 for n in range(5)]
+    return "%d %d %.2f %.2f %.3f %.3f %d %d %d 0x%X %s %d %d" % (
+        msec, seq, ptime / 100.0, temp / 100.0, level / 1000.0, wil / 1000.0,
+        rpm, laundry, detergent, warnings, " ".join(map(str, bits)), prog, step)
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.stderr.write(__doc__)
+        return 2
+    source = argv[1]
+    if source.startswith("/dev/") or source.upper().startswith("COM"):
+        import serial                               # pyserial
+        stream = serial.Serial(source, 115200, timeout=0.1)
+        read = lambda: stream.read(256)
+    else:
+        stream = open(source, "rb")
+        read = lambda: stream.read(4096) or None
+
+    decoder = Decoder()
+    try:
+        while True:
+            data = read()
+            if data is None:
+                break
+            for kind, item in decoder.feed(data):
+                if kind == "frame":
+                    print(format_frame(item), flush=True)
+                else:
+                    print(item, file=sys.stderr)
+    except KeyboardInterrupt:
+        pass
+    print("# crc errors %d, lost frames %d, garbage bytes %d" % (decoder.crc_errors, decoder.lost, decoder.garbage),
+          file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
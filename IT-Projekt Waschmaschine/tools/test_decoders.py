@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Tests of the stream decoders in tools, run with
+
+  python3 -m unittest discover -s tools
+
+Every test runs with an alarm, so a decoder stuck in its loop fails instead of hanging.
+"""
+
+import os
+import signal
+import struct
+import sys
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import i2c_capture                                  # noqa: E402
+import telemetry_decode                             # noqa: E402
+from serial_frames import crc16_ccitt               # noqa: E402
+
+TIMEOUT_S = 5
+
+
+def telemetry_frame(seq, msec=1000):
+    """A valid telemetry frame as sent by the controller."""
+    body = telemetry_decode.LAYOUT.pack(
+        telemetry_decode.PAYLOAD, telemetry_decode.VERSION, seq, msec, 42,
+        6000, 1300, 1000, 800, 5, 3, 0, 0x13, 1, 2, 0)
+    return telemetry_decode.SYNC + body + struct.pack("<H", crc16_ccitt(body))
+
+
+def i2c_record(seq, request=b"D=1", response=b"D=1", slave=8):
+    """A valid I2C transaction record as sent by the controller."""
+    size = i2c_capture.HEADER.size - 1 + len(request) + len(response)  # behind the length byte
+    body = i2c_capture.HEADER.pack(size, i2c_capture.VERSION, seq, 123456, slave, 0x10, len(response),
+                                   850, len(request)) + request + response
+    return i2c_capture.SYNC + body + struct.pack("<H", crc16_ccitt(body))
+
+
+class DecoderTest(unittest.TestCase):
+    """Common alarm for all decoder tests."""
+
+    def setUp(self):
+        signal.signal(signal.SIGALRM, self._timeout)
+        signal.alarm(TIMEOUT_S)
+
+    def tearDown(self):
+        signal.alarm(0)
+
+    @staticmethod
+    def _timeout(signum, frame):
+        raise AssertionError("decoder does not return")
+
+
+class TelemetryDecoderTest(DecoderTest):
+
+    def decode(self, *chunks):
+        decoder = telemetry_decode.Decoder()
+        items = []
+        for chunk in chunks:
+            items += list(decoder.feed(chunk))
+        return decoder, items
+
+    def test_crc_of_check_string(self):
+        self.assertEqual(crc16_ccitt(b"123456789"), 0x29B1)
+
+    def test_frame_between_text(self):
+        decoder, items = self.decode(b"# banner\r\n" + telemetry_frame(1) + b"# WP1 step 1\r\n")
+        self.assertEqual([i[0] for i in items], ["text", "frame", "text"])
+        self.assertEqual(items[1][1][2], 1)
+        self.assertEqual(items[1][1][5], 6000)
+
+    def test_frame_in_pieces(self):
+        frame = telemetry_frame(7)
+        decoder, items = self.decode(*[frame[i:i + 1] for i in range(len(frame))])
+        self.assertEqual([i[0] for i in items], ["frame"])
+
+    def test_stray_byte_before_frame(self):
+        decoder, items = self.decode(b"x" + telemetry_frame(1))
+        self.assertEqual([i[0] for i in items], ["frame"])
+        self.assertEqual(decoder.garbage, 1)
+
+    def test_garbage_bad_frame_good_frame(self):
+        bad = bytearray(telemetry_frame(1))
+        bad[10] ^= 0xFF
+        decoder, items = self.decode(b"\x00\xff garbage", bytes(bad), telemetry_frame(2))
+        self.assertEqual([i[0] for i in items], ["frame"])
+        self.assertEqual(items[0][1][2], 2)
+        self.assertEqual(decoder.crc_errors, 1)
+        self.assertEqual(decoder.lost, 0)
+        self.assertEqual(decoder.buffer, bytearray())
+
+    def test_long_garbage_then_split_sync(self):
+        frame = telemetry_frame(3)
+        decoder, items = self.decode(b"x" * 300 + frame[:1], frame[1:])
+        self.assertEqual([i[0] for i in items], ["frame"])
+        self.assertEqual(decoder.garbage, 300)
+
+    def test_lost_frames(self):
+        decoder, items = self.decode(telemetry_frame(1), telemetry_frame(4))
+        self.assertEqual(len(items), 2)
+        self.assertEqual(decoder.lost, 2)
+
+
+class I2CCaptureDecoderTest(DecoderTest):
+
+    def decode(self, *chunks):
+        decoder = i2c_capture.Decoder()
+        items = []
+        for chunk in chunks:
+            items += list(decoder.feed(chunk))
+        return decoder, items
+
+    def test_record_between_text(self):
+        decoder, items = self.decode(b"# c=1\r\n" + i2c_record(5) + b"# done\r\n")
+        self.assertEqual([i[0] for i in items], ["text", "record", "text"])
+        raw, (fields, request, response) = items[1][1:]
+        self.assertEqual(raw, i2c_record(5))
+        self.assertEqual((fields[2], request, response), (5, b"D=1", b"D=1"))
+
+    def test_record_in_pieces(self):
+        record = i2c_record(7)
+        decoder, items = self.decode(*[record[i:i + 1] for i in range(len(record))])
+        self.assertEqual([i[0] for i in items], ["record"])
+
+    def test_stray_byte_and_short_sync(self):
+        decoder, items = self.decode(b"x\xa5\xc3\x05abcdefg")
+        self.assertEqual(items, [])
+        self.assertEqual(decoder.crc_errors, 1)
+        self.assertEqual(decoder.garbage, 1)
+
+    def test_garbage_bad_record_good_record(self):
+        bad = bytearray(i2c_record(1))
+        bad[-3] ^= 0xFF
+        decoder, items = self.decode(b"\x00\xff garbage", bytes(bad), i2c_record(2))
+        self.assertEqual([i[0] for i in items], ["record"])
+        self.assertEqual(items[0][2][0][2], 2)
+        self.assertEqual(decoder.crc_errors, 1)
+        self.assertEqual(decoder.buffer, bytearray())
+
+    def test_state_record(self):
+        legacy = b"\x00" * 15 + b"\x80"
+        decoder, items = self.decode(i2c_record(0, legacy, b"\x01\x00\x01", slave=0), i2c_record(1))
+        self.assertEqual([i[0] for i in items], ["record", "record"])
+        self.assertEqual(i2c_capture.format_record(items[0][2]),
+                         "0 123456 state legacy=%s 010001" % legacy.hex())
+        self.assertEqual(i2c_capture.format_record(items[1][2]), "1 123456 8 0x10 3 850 D=1 -> D=1")
+
+    def test_lost_records(self):
+        decoder, items = self.decode(i2c_record(255), i2c_record(2))
+        self.assertEqual(len(items), 2)
+        self.assertEqual(decoder.lost, 2)
+
+
+if __name__ == "__main__":
+    unittest.main()